@@ -0,0 +1,165 @@
+#include "Game/BatchNoise.hpp"
+#include "Engine/Core/Noise.hpp"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATCH_NOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+//Same lattice as the engine's Perlin noise, eight unit gradients picked by the low bits of the corner's noise
+static const float PERLIN_GRADIENTS_X[8] = { 0.923879533f, 0.382683432f, -0.382683432f, -0.923879533f, -0.923879533f, -0.382683432f, 0.382683432f, 0.923879533f };
+static const float PERLIN_GRADIENTS_Y[8] = { 0.382683432f, 0.923879533f, 0.923879533f, 0.382683432f, -0.382683432f, -0.923879533f, -0.923879533f, -0.382683432f };
+static const float PERLIN_OCTAVE_OFFSET = 0.636764989f;
+static const float PERLIN_NOISE_NORMALIZER = 1.f / 0.662578106f;		//2D Perlin noise peaks at 0.662578106
+
+
+PerlinNoiseField::PerlinNoiseField(float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed)
+	: m_scale(scale)
+	, m_numOctaves(numOctaves)
+	, m_octavePersistence(octavePersistence)
+	, m_octaveScale(octaveScale)
+	, m_renormalize(renormalize)
+	, m_seed(seed)
+{
+
+}
+
+float SampleNoiseField(const PerlinNoiseField& field, float posX, float posY, float octaveScale)
+{
+	return Compute2dPerlinNoise(posX, posY, field.m_scale, field.m_numOctaves, field.m_octavePersistence, octaveScale, field.m_renormalize, field.m_seed);
+}
+
+#if defined(BATCH_NOISE_SSE2)
+static __m128 SmoothStep4(__m128 values)
+{
+	//Multiplied in the same order as the scalar 3t*t - 2t*t*t so both round identically
+	__m128 threeTSquared = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(3.f), values), values);
+	__m128 twoTCubed = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.f), values), values), values);
+	return _mm_sub_ps(threeTSquared, twoTCubed);
+}
+
+static __m128 Floor4(__m128 values)
+{
+	//Truncation rounds negative values up, so step those back down by one
+	__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(values));
+	return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmplt_ps(values, truncated), _mm_set1_ps(1.f)));
+}
+
+static void Compute2dPerlinNoise4(const PerlinNoiseField& field, __m128 posX, __m128 posY, __m128 octaveScale, float* out_values)
+{
+	const __m128 ones = _mm_set1_ps(1.f);
+	const __m128 octaveOffset = _mm_set1_ps(PERLIN_OCTAVE_OFFSET);
+	const __m128 normalizer = _mm_set1_ps(PERLIN_NOISE_NORMALIZER);
+
+	__m128 invScale = _mm_set1_ps(1.f / field.m_scale);
+	__m128 currentX = _mm_mul_ps(posX, invScale);
+	__m128 currentY = _mm_mul_ps(posY, invScale);
+	__m128 totalNoise = _mm_setzero_ps();
+	float totalAmplitude = 0.f;
+	float currentAmplitude = 1.f;
+	unsigned int seed = field.m_seed;
+
+	for (unsigned int octaveIndex = 0; octaveIndex < field.m_numOctaves; ++octaveIndex)
+	{
+		__m128 cellMinsX = Floor4(currentX);
+		__m128 cellMinsY = Floor4(currentY);
+
+		//The corner hashes come from the engine one lane at a time, everything after them runs on all four lanes
+		int westX[4];
+		int southY[4];
+		_mm_storeu_si128((__m128i*)westX, _mm_cvttps_epi32(cellMinsX));
+		_mm_storeu_si128((__m128i*)southY, _mm_cvttps_epi32(cellMinsY));
+
+		float gradientSouthWestX[4], gradientSouthWestY[4], gradientSouthEastX[4], gradientSouthEastY[4];
+		float gradientNorthWestX[4], gradientNorthWestY[4], gradientNorthEastX[4], gradientNorthEastY[4];
+		for (int laneIndex = 0; laneIndex < 4; ++laneIndex)
+		{
+			unsigned int southWestIndex = Get2dNoiseUint(westX[laneIndex], southY[laneIndex], seed) & 7;
+			unsigned int southEastIndex = Get2dNoiseUint(westX[laneIndex] + 1, southY[laneIndex], seed) & 7;
+			unsigned int northWestIndex = Get2dNoiseUint(westX[laneIndex], southY[laneIndex] + 1, seed) & 7;
+			unsigned int northEastIndex = Get2dNoiseUint(westX[laneIndex] + 1, southY[laneIndex] + 1, seed) & 7;
+
+			gradientSouthWestX[laneIndex] = PERLIN_GRADIENTS_X[southWestIndex];
+			gradientSouthWestY[laneIndex] = PERLIN_GRADIENTS_Y[southWestIndex];
+			gradientSouthEastX[laneIndex] = PERLIN_GRADIENTS_X[southEastIndex];
+			gradientSouthEastY[laneIndex] = PERLIN_GRADIENTS_Y[southEastIndex];
+			gradientNorthWestX[laneIndex] = PERLIN_GRADIENTS_X[northWestIndex];
+			gradientNorthWestY[laneIndex] = PERLIN_GRADIENTS_Y[northWestIndex];
+			gradientNorthEastX[laneIndex] = PERLIN_GRADIENTS_X[northEastIndex];
+			gradientNorthEastY[laneIndex] = PERLIN_GRADIENTS_Y[northEastIndex];
+		}
+
+		__m128 displacementWest = _mm_sub_ps(currentX, cellMinsX);
+		__m128 displacementSouth = _mm_sub_ps(currentY, cellMinsY);
+		__m128 displacementEast = _mm_sub_ps(displacementWest, ones);
+		__m128 displacementNorth = _mm_sub_ps(displacementSouth, ones);
+
+		__m128 dotSouthWest = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gradientSouthWestX), displacementWest), _mm_mul_ps(_mm_loadu_ps(gradientSouthWestY), displacementSouth));
+		__m128 dotSouthEast = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gradientSouthEastX), displacementEast), _mm_mul_ps(_mm_loadu_ps(gradientSouthEastY), displacementSouth));
+		__m128 dotNorthWest = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gradientNorthWestX), displacementWest), _mm_mul_ps(_mm_loadu_ps(gradientNorthWestY), displacementNorth));
+		__m128 dotNorthEast = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gradientNorthEastX), displacementEast), _mm_mul_ps(_mm_loadu_ps(gradientNorthEastY), displacementNorth));
+
+		__m128 weightEast = SmoothStep4(displacementWest);
+		__m128 weightNorth = SmoothStep4(displacementSouth);
+		__m128 weightWest = _mm_sub_ps(ones, weightEast);
+		__m128 weightSouth = _mm_sub_ps(ones, weightNorth);
+
+		__m128 blendSouth = _mm_add_ps(_mm_mul_ps(weightEast, dotSouthEast), _mm_mul_ps(weightWest, dotSouthWest));
+		__m128 blendNorth = _mm_add_ps(_mm_mul_ps(weightEast, dotNorthEast), _mm_mul_ps(weightWest, dotNorthWest));
+		__m128 octaveNoise = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(weightSouth, blendSouth), _mm_mul_ps(weightNorth, blendNorth)), normalizer);
+
+		totalNoise = _mm_add_ps(totalNoise, _mm_mul_ps(octaveNoise, _mm_set1_ps(currentAmplitude)));
+		totalAmplitude += currentAmplitude;
+		currentAmplitude *= field.m_octavePersistence;
+		currentX = _mm_add_ps(_mm_mul_ps(currentX, octaveScale), octaveOffset);
+		currentY = _mm_add_ps(_mm_mul_ps(currentY, octaveScale), octaveOffset);
+		++seed;
+	}
+
+	if (field.m_renormalize && totalAmplitude > 0.f)
+	{
+		const __m128 halves = _mm_set1_ps(0.5f);
+		totalNoise = _mm_div_ps(totalNoise, _mm_set1_ps(totalAmplitude));
+		totalNoise = SmoothStep4(_mm_add_ps(_mm_mul_ps(totalNoise, halves), halves));
+		totalNoise = _mm_sub_ps(_mm_mul_ps(totalNoise, _mm_set1_ps(2.f)), ones);
+	}
+
+	_mm_storeu_ps(out_values, totalNoise);
+}
+#endif
+
+void Compute2dPerlinNoiseRow(const PerlinNoiseField& field, bool isBatched, float startX, float posY, float spacing, int numSamples, float* out_values, const float* octaveScales)
+{
+	int sampleIndex = 0;
+
+#if defined(BATCH_NOISE_SSE2)
+	if (isBatched)
+	{
+		__m128 laneOffsets = _mm_mul_ps(_mm_set_ps(3.f, 2.f, 1.f, 0.f), _mm_set1_ps(spacing));
+		__m128 laneY = _mm_set1_ps(posY);
+		for (; sampleIndex + 4 <= numSamples; sampleIndex += 4)
+		{
+			__m128 laneX = _mm_add_ps(_mm_set1_ps(startX + ((float)sampleIndex * spacing)), laneOffsets);
+			__m128 laneOctaveScale = octaveScales ? _mm_loadu_ps(octaveScales + sampleIndex) : _mm_set1_ps(field.m_octaveScale);
+			Compute2dPerlinNoise4(field, laneX, laneY, laneOctaveScale, out_values + sampleIndex);
+		}
+	}
+#endif
+
+	//Samples left over after the last full set of lanes, or every sample when the batched path is off
+	for (; sampleIndex < numSamples; ++sampleIndex)
+	{
+		float octaveScale = octaveScales ? octaveScales[sampleIndex] : field.m_octaveScale;
+		out_values[sampleIndex] = SampleNoiseField(field, startX + ((float)sampleIndex * spacing), posY, octaveScale);
+	}
+}
+
+bool IsBatchedNoiseSupported()
+{
+#if defined(BATCH_NOISE_SSE2)
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+
+//Arguments of one Compute2dPerlinNoise field, so a field can be sampled many times at once
+struct PerlinNoiseField
+{
+	float m_scale;
+	unsigned int m_numOctaves;
+	float m_octavePersistence;
+	float m_octaveScale;
+	bool m_renormalize;
+	unsigned int m_seed;
+
+	PerlinNoiseField(float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0);
+};
+
+
+float SampleNoiseField(const PerlinNoiseField& field, float posX, float posY, float octaveScale);
+
+//Samples the positions startX, startX + spacing, ... at posY, octaveScales optionally overrides the field's octave scale per sample
+//isBatched takes four samples at a time where the CPU supports it, otherwise every sample comes from Compute2dPerlinNoise
+void Compute2dPerlinNoiseRow(const PerlinNoiseField& field, bool isBatched, float startX, float posY, float spacing, int numSamples, float* out_values, const float* octaveScales = nullptr);
+
+bool IsBatchedNoiseSupported();
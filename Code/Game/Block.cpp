@@ -4,6 +4,7 @@
 Block::Block(BlockType type)
 	: m_type(type)
 	, m_lightingAndFlags(0x00)
+	, m_skyLightValue(0)
 {
 
 }
@@ -11,6 +12,7 @@ Block::Block(BlockType type)
 Block::Block()
 	: m_type(BLOCK_TYPE_AIR)
 	, m_lightingAndFlags(0x00)
+	, m_skyLightValue(0)
 {
 
 }
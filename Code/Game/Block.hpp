@@ -7,7 +7,8 @@ class Block
 {
 private:
 	BlockType m_type;
-	unsigned char m_lightingAndFlags;
+	unsigned char m_lightingAndFlags;		//block light in the low bits, see LIGHT_MASK
+	unsigned char m_skyLightValue;
 
 public:
 	Block();
@@ -16,17 +17,14 @@ public:
 	BlockType GetBlockType() const;
 	void ChangeType(BlockType newType);
 
-	unsigned int GetLightValue() const;
-	void SetLightValue(unsigned int newLightValue);
+	unsigned int GetLightValue(LightChannel channel) const;
+	void SetLightValue(LightChannel channel, unsigned int newLightValue);
+	unsigned char GetPackedLightValues() const;
 
 	bool GetIsLightingDirty() const;
 	void SetIsLightingDirty();
 	void ClearIsLightingDirty();
 
-	bool GetIsSky() const;
-	void SetIsSky();
-	void ClearIsSky();
-
 	bool GetIsOpaque() const;
 
 	bool GetIsSolid() const;
@@ -45,18 +43,31 @@ inline void Block::ChangeType(BlockType newType)
 	m_type = newType;
 }
 
-inline void Block::SetLightValue(unsigned int newLightValue)
+inline void Block::SetLightValue(LightChannel channel, unsigned int newLightValue)
 {
 	ASSERT_OR_DIE(newLightValue < 16, "Invalid light value.");
+	if (channel == LIGHT_CHANNEL_SKY)
+	{
+		m_skyLightValue = (unsigned char)newLightValue;
+		return;
+	}
+
 	m_lightingAndFlags &= ~LIGHT_MASK;
 	m_lightingAndFlags |= newLightValue;
 }
 
-inline unsigned int Block::GetLightValue() const
+inline unsigned int Block::GetLightValue(LightChannel channel) const
 {
+	if (channel == LIGHT_CHANNEL_SKY)
+		return m_skyLightValue;
 	return m_lightingAndFlags & LIGHT_MASK;
 }
 
+inline unsigned char Block::GetPackedLightValues() const
+{
+	return PackLightValues(m_skyLightValue, m_lightingAndFlags & LIGHT_MASK);
+}
+
 
 inline bool Block::GetIsLightingDirty() const
 {
@@ -73,21 +84,6 @@ inline void Block::ClearIsLightingDirty()
 	m_lightingAndFlags &= ~LIGHT_DIRTY_MASK;
 }
 
-inline bool Block::GetIsSky() const
-{
-	return (m_lightingAndFlags & IS_SKY_MASK) == IS_SKY_MASK;
-}
-
-inline void Block::SetIsSky()
-{
-	m_lightingAndFlags |= IS_SKY_MASK;
-}
-
-inline void Block::ClearIsSky()
-{
-	m_lightingAndFlags &= ~IS_SKY_MASK;
-}
-
 inline bool Block::GetIsOpaque() const
 {
 	return (m_lightingAndFlags & IS_OPAQUE_MASK) == IS_OPAQUE_MASK;
@@ -1,8 +1,8 @@
 #include "Game/Chunk.hpp"
-#include "Engine/Core/Noise.hpp"
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Game/BlockInfo.hpp"
+#include "Game/RecordingRenderer.hpp"
 #include "Game/App.hpp"
 #include "Engine/Core/ProfileLogScope.hpp"
 
@@ -10,9 +10,32 @@
 
 Chunk::Chunk()
 	: m_chunkCoords(IntVector2(0, 0))
-	, m_isVBODirty(true)
+	, m_vertexes()
+	, m_faceLightValues()
+	, m_vboID(0)
 	, m_numVertexesInVBO(0)
+	, m_isVBODirty(true)
+	, m_hasConnectivityChanged(true)
+	, m_lodLevel(0)
+	, m_lightingSlot(-1)
+	, m_skyLightLevel(SKY_LIGHT_VALUE)
+	, m_frustumFrameNumber(-1)
+	, m_drawnFrameNumber(-1)
 {
+	for (int sectionIndex = 0; sectionIndex < SECTIONS_PER_CHUNK; ++sectionIndex)
+	{
+		m_sectionVisitedFrameNumbers[sectionIndex] = -1;
+		for (int faceIndex = 0; faceIndex < NUM_SECTION_FACES; ++faceIndex)
+		{
+			m_sectionConnectivity[sectionIndex][faceIndex] = 0;
+		}
+	}
+
+	for (int columnIndex = 0; columnIndex < BLOCKS_PER_LAYER; ++columnIndex)
+	{
+		m_skyHeights[columnIndex] = CHUNK_Z;
+	}
+
 	g_theRenderer->CreateVBOs(1, &m_vboID);
 }
 
@@ -21,13 +44,36 @@ Chunk::Chunk(const IntVector2& chunkCoords)
 	, m_chunkWorldMins()
 	, m_chunkWorldMaxs()
 	, m_chunkCenter()
-	, m_isVBODirty(true)
+	, m_vertexes()
+	, m_faceLightValues()
+	, m_vboID(0)
 	, m_numVertexesInVBO(0)
+	, m_isVBODirty(true)
 	, m_northNeighbor(nullptr)
 	, m_southNeighbor(nullptr)
 	, m_eastNeighbor(nullptr)
 	, m_westNeighbor(nullptr)
+	, m_hasConnectivityChanged(true)
+	, m_lodLevel(0)
+	, m_lightingSlot(-1)
+	, m_skyLightLevel(SKY_LIGHT_VALUE)
+	, m_frustumFrameNumber(-1)
+	, m_drawnFrameNumber(-1)
 {
+	for (int sectionIndex = 0; sectionIndex < SECTIONS_PER_CHUNK; ++sectionIndex)
+	{
+		m_sectionVisitedFrameNumbers[sectionIndex] = -1;
+		for (int faceIndex = 0; faceIndex < NUM_SECTION_FACES; ++faceIndex)
+		{
+			m_sectionConnectivity[sectionIndex][faceIndex] = 0;
+		}
+	}
+
+	for (int columnIndex = 0; columnIndex < BLOCKS_PER_LAYER; ++columnIndex)
+	{
+		m_skyHeights[columnIndex] = CHUNK_Z;
+	}
+
 	m_chunkWorldMins = CalcChunkMins();
 	m_chunkWorldMaxs = m_chunkWorldMins + Vector3((float)CHUNK_X, (float)CHUNK_Y, 0.f);
 	m_chunkCenter = (m_chunkWorldMaxs + m_chunkWorldMins) / 2;
@@ -61,24 +107,26 @@ void Chunk::Update(float deltaSeconds)
 	deltaSeconds;
 }
 
-void Chunk::Render() const
+void Chunk::Render(RecordingRenderer& renderer) const
 {
-	Vector3 chunkWorldMins = CalcChunkMins();
-
-	g_theRenderer->PushMatrix();
-	g_theRenderer->TranslateCoordinates3D(chunkWorldMins);
-
-	g_theRenderer->BindBuffer(m_vboID);
-	g_theRenderer->DrawVBO(m_numVertexesInVBO, PRIMITIVE_QUADS);
-	g_theRenderer->BindBuffer(0);
-
-	g_theRenderer->PopMatrix();
+	//Vertexes are already in world space, so there is no matrix to push and the buffer is left bound for the next chunk
+	renderer.BindBuffer(m_vboID);
+	renderer.DrawVBO(m_numVertexesInVBO, PRIMITIVE_QUADS);
 }
 
 void Chunk::RebuildVertexArray()
 {
 	std::vector<Vertex3D> vertexArray;
-	vertexArray.reserve(CHUNK_X * CHUNK_Y * 4 * 4);
+	vertexArray.reserve(m_vertexes.empty() ? CHUNK_X * CHUNK_Y * 4 * 4 : m_vertexes.size());
+	std::vector<unsigned char> faceLightValues;
+	faceLightValues.reserve(vertexArray.capacity() / VERTEXES_PER_FACE);
+
+	if (m_lodLevel > 0)
+	{
+		BuildLodVertexArray(vertexArray, faceLightValues);
+		FinishVertexArray(vertexArray, faceLightValues);
+		return;
+	}
 
 	for (int zIndex = 0; zIndex < CHUNK_Z; zIndex++)
 	{
@@ -89,8 +137,10 @@ void Chunk::RebuildVertexArray()
 				IntVector3 blockCoords = IntVector3(xIndex, yIndex, zIndex);
 				int blockIndex = GetBlockIndexForBlockCoords(blockCoords);
 				BlockInfo blockToDraw(this, blockIndex);
+				Vector3 blockPosition = m_chunkWorldMins + Vector3(blockCoords);		//vertexes are baked in world space so drawing a chunk needs no transform
 
-				if(BlockDefinition::s_blockDefinitions[blockToDraw.GetBlock()->GetBlockType()]->m_isOpaque)
+				const BlockDefinition* blockDefinition = BlockDefinition::s_blockDefinitions[blockToDraw.GetBlock()->GetBlockType()];
+				if(blockDefinition->m_isOpaque)
 				{
 					//Get neighboring blocks
 					BlockInfo bottomNeighbor = blockToDraw.GetBelowBlock();
@@ -103,308 +153,421 @@ void Chunk::RebuildVertexArray()
 					//For each face, check is neighbor is opaque
 					//if false, add vertexes for face
 					if (!bottomNeighbor.m_chunk || !BlockDefinition::s_blockDefinitions[bottomNeighbor.GetBlock()->GetBlockType()]->m_isOpaque)
-					{
-						AABB2 bottomTexCoords = g_blockSprites->GetTexCoordsForSpriteIndex(BlockDefinition::s_blockDefinitions[blockToDraw.GetBlock()->GetBlockType()]->m_bottomSpriteIndex);
-						unsigned char lightRGBAValue;
-						if (!bottomNeighbor.m_chunk)
-							lightRGBAValue = LIGHT_RGBA_VALUES[SKY_LIGHT_VALUE];
-						else
-							lightRGBAValue = LIGHT_RGBA_VALUES[bottomNeighbor.GetBlock()->GetLightValue()];
-
-						Vertex3D bottomFaceVertexes[] = 
-						{
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 0.f, 0.f), Vector2(bottomTexCoords.maxs.x, bottomTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 0.f, 0.f), Vector2(bottomTexCoords.mins.x, bottomTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 1.f, 0.f), Vector2(bottomTexCoords.mins.x, bottomTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 1.f, 0.f), Vector2(bottomTexCoords.maxs.x, bottomTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255))
-						};
-
-						vertexArray.push_back(bottomFaceVertexes[0]);
-						vertexArray.push_back(bottomFaceVertexes[1]);
-						vertexArray.push_back(bottomFaceVertexes[2]);
-						vertexArray.push_back(bottomFaceVertexes[3]);
-					}
+						AddFaceVertexes(vertexArray, faceLightValues, blockPosition, 1.f, g_bottomFaceVertexes, blockDefinition->m_bottomSpriteIndex, GetFaceLightValues(bottomNeighbor));
 
 					if (!topNeighbor.m_chunk || !BlockDefinition::s_blockDefinitions[topNeighbor.GetBlock()->GetBlockType()]->m_isOpaque)
-					{
-						AABB2 topTexCoords = g_blockSprites->GetTexCoordsForSpriteIndex(BlockDefinition::s_blockDefinitions[blockToDraw.GetBlock()->GetBlockType()]->m_topSpriteIndex);
-						unsigned char lightRGBAValue;
-						if (!topNeighbor.m_chunk)
-							lightRGBAValue = LIGHT_RGBA_VALUES[SKY_LIGHT_VALUE];
-						else
-							lightRGBAValue = LIGHT_RGBA_VALUES[topNeighbor.GetBlock()->GetLightValue()];
-
-						Vertex3D topFaceVertexes[] =
-						{
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 0.f, 1.f), Vector2(topTexCoords.mins.x, topTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 0.f, 1.f), Vector2(topTexCoords.maxs.x, topTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 1.f, 1.f), Vector2(topTexCoords.maxs.x, topTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 1.f, 1.f), Vector2(topTexCoords.mins.x, topTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255))
-						};
-
-						vertexArray.push_back(topFaceVertexes[0]);
-						vertexArray.push_back(topFaceVertexes[1]);
-						vertexArray.push_back(topFaceVertexes[2]);
-						vertexArray.push_back(topFaceVertexes[3]);
-					}
+						AddFaceVertexes(vertexArray, faceLightValues, blockPosition, 1.f, g_topFaceVertexes, blockDefinition->m_topSpriteIndex, GetFaceLightValues(topNeighbor));
 
 					if (!northNeighbor.m_chunk || northNeighbor.m_chunk != this || !BlockDefinition::s_blockDefinitions[northNeighbor.GetBlock()->GetBlockType()]->m_isOpaque)
-					{
-						AABB2 northTexCoords = g_blockSprites->GetTexCoordsForSpriteIndex(BlockDefinition::s_blockDefinitions[blockToDraw.GetBlock()->GetBlockType()]->m_northSpriteIndex);
-						unsigned char lightRGBAValue;
-						if (!northNeighbor.m_chunk)
-							lightRGBAValue = LIGHT_RGBA_VALUES[SKY_LIGHT_VALUE];
-						else
-							lightRGBAValue = LIGHT_RGBA_VALUES[northNeighbor.GetBlock()->GetLightValue()];
-
-						Vertex3D northFaceVertexes[] = 
-						{
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 1.f, 0.f), Vector2(northTexCoords.mins.x, northTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 1.f, 0.f), Vector2(northTexCoords.maxs.x, northTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 1.f, 1.f), Vector2(northTexCoords.maxs.x, northTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 1.f, 1.f), Vector2(northTexCoords.mins.x, northTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255))
-						};
-
-						vertexArray.push_back(northFaceVertexes[0]);
-						vertexArray.push_back(northFaceVertexes[1]);
-						vertexArray.push_back(northFaceVertexes[2]);
-						vertexArray.push_back(northFaceVertexes[3]);
-					}
+						AddFaceVertexes(vertexArray, faceLightValues, blockPosition, 1.f, g_northFaceVertexes, blockDefinition->m_northSpriteIndex, GetFaceLightValues(northNeighbor));
 
 					if (!southNeighbor.m_chunk || southNeighbor.m_chunk != this || !BlockDefinition::s_blockDefinitions[southNeighbor.GetBlock()->GetBlockType()]->m_isOpaque)
-					{
-						AABB2 southTexCoords = g_blockSprites->GetTexCoordsForSpriteIndex(BlockDefinition::s_blockDefinitions[blockToDraw.GetBlock()->GetBlockType()]->m_southSpriteIndex);
-						unsigned char lightRGBAValue;
-						if (!southNeighbor.m_chunk)
-							lightRGBAValue = LIGHT_RGBA_VALUES[SKY_LIGHT_VALUE];
-						else
-							lightRGBAValue = LIGHT_RGBA_VALUES[southNeighbor.GetBlock()->GetLightValue()];
-
-						Vertex3D southFaceVertexes[] = 
-						{
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 0.f, 0.f), Vector2(southTexCoords.mins.x, southTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 0.f, 0.f), Vector2(southTexCoords.maxs.x, southTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 0.f, 1.f), Vector2(southTexCoords.maxs.x, southTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 0.f, 1.f), Vector2(southTexCoords.mins.x, southTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255))
-						};
-
-						vertexArray.push_back(southFaceVertexes[0]);
-						vertexArray.push_back(southFaceVertexes[1]);
-						vertexArray.push_back(southFaceVertexes[2]);
-						vertexArray.push_back(southFaceVertexes[3]);
-					}
+						AddFaceVertexes(vertexArray, faceLightValues, blockPosition, 1.f, g_southFaceVertexes, blockDefinition->m_southSpriteIndex, GetFaceLightValues(southNeighbor));
 
 					if (!eastNeighbor.m_chunk || eastNeighbor.m_chunk != this || !BlockDefinition::s_blockDefinitions[eastNeighbor.GetBlock()->GetBlockType()]->m_isOpaque)
-					{
-						AABB2 eastTexCoords = g_blockSprites->GetTexCoordsForSpriteIndex(BlockDefinition::s_blockDefinitions[blockToDraw.GetBlock()->GetBlockType()]->m_eastSpriteIndex);
-						unsigned char lightRGBAValue;
-						if (!eastNeighbor.m_chunk)
-							lightRGBAValue = LIGHT_RGBA_VALUES[SKY_LIGHT_VALUE];
-						else
-							lightRGBAValue = LIGHT_RGBA_VALUES[eastNeighbor.GetBlock()->GetLightValue()];
-
-						Vertex3D eastFaceVertexes[] = 
-						{
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 0.f, 0.f), Vector2(eastTexCoords.mins.x, eastTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 1.f, 0.f), Vector2(eastTexCoords.maxs.x, eastTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 1.f, 1.f), Vector2(eastTexCoords.maxs.x, eastTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(1.f, 0.f, 1.f), Vector2(eastTexCoords.mins.x, eastTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255))
-						};
-
-						vertexArray.push_back(eastFaceVertexes[0]);
-						vertexArray.push_back(eastFaceVertexes[1]);
-						vertexArray.push_back(eastFaceVertexes[2]);
-						vertexArray.push_back(eastFaceVertexes[3]);
-					}
+						AddFaceVertexes(vertexArray, faceLightValues, blockPosition, 1.f, g_eastFaceVertexes, blockDefinition->m_eastSpriteIndex, GetFaceLightValues(eastNeighbor));
 
 					if (!westNeighbor.m_chunk || westNeighbor.m_chunk != this || !BlockDefinition::s_blockDefinitions[westNeighbor.GetBlock()->GetBlockType()]->m_isOpaque)
-					{
-						AABB2 westTexCoords = g_blockSprites->GetTexCoordsForSpriteIndex(BlockDefinition::s_blockDefinitions[blockToDraw.GetBlock()->GetBlockType()]->m_westSpriteIndex);
-						unsigned char lightRGBAValue;
-						if (!westNeighbor.m_chunk)
-							lightRGBAValue = LIGHT_RGBA_VALUES[SKY_LIGHT_VALUE];
-						else
-							lightRGBAValue = LIGHT_RGBA_VALUES[westNeighbor.GetBlock()->GetLightValue()];
-
-						Vertex3D westFaceVertexes[] = 
-						{
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 1.f, 0.f), Vector2(westTexCoords.mins.x, westTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 0.f, 0.f), Vector2(westTexCoords.maxs.x, westTexCoords.maxs.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 0.f, 1.f), Vector2(westTexCoords.maxs.x, westTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255)),
-							Vertex3D(Vector3(blockCoords) + Vector3(0.f, 1.f, 1.f), Vector2(westTexCoords.mins.x, westTexCoords.mins.y), Rgba(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255))
-						};
-
-						vertexArray.push_back(westFaceVertexes[0]);
-						vertexArray.push_back(westFaceVertexes[1]);
-						vertexArray.push_back(westFaceVertexes[2]);
-						vertexArray.push_back(westFaceVertexes[3]);
-					}
+						AddFaceVertexes(vertexArray, faceLightValues, blockPosition, 1.f, g_westFaceVertexes, blockDefinition->m_westSpriteIndex, GetFaceLightValues(westNeighbor));
 				}
 			}
 		}
 	}
 
-	g_theRenderer->BindBuffer(m_vboID);
-	g_theRenderer->BufferData(vertexArray.data(), vertexArray.size() * sizeof(Vertex3D));
-	g_theRenderer->BindBuffer(0);
-	m_numVertexesInVBO = vertexArray.size();
+	FinishVertexArray(vertexArray, faceLightValues);
+}
+
+void Chunk::FinishVertexArray(std::vector<Vertex3D>& vertexArray, std::vector<unsigned char>& faceLightValues)
+{
+	m_vertexes.swap(vertexArray);
+	m_faceLightValues.swap(faceLightValues);
 	m_isVBODirty = false;
+	UploadVertexBuffer();
+
+	CalculateSectionConnectivity();
 }
 
-void Chunk::GenerateChunk()
+void Chunk::UploadVertexBuffer()
 {
-	std::vector<unsigned char> fileBuffer;
-	std::string filePath = "Data/Save/Chunk_(" + std::to_string(m_chunkCoords.x) + "," + std::to_string(m_chunkCoords.y) + ").cnk";
-	if (ReadBufferFromFile(fileBuffer, filePath))
-	{
-		PopulateFromFile(fileBuffer);
-	}
-	else
-	{
-		PopulateFromNoise();
-	}
+	g_theRenderer->BindBuffer(m_vboID);
+	g_theRenderer->BufferData(m_vertexes.data(), m_vertexes.size() * sizeof(Vertex3D));
+	g_theRenderer->BindBuffer(0);
+	m_numVertexesInVBO = m_vertexes.size();
 }
 
-void Chunk::PopulateFromFile(const std::vector<unsigned char>& fileBuffer)
+void Chunk::ApplySkyLightLevel(unsigned int skyLightLevel)
 {
-	ASSERT_OR_DIE(fileBuffer[0] == g_GAME_VERSION, "Chunk file version mismatch");
+	if (skyLightLevel == m_skyLightLevel)
+		return;
 
-	int currentBlockIndex = 0;
-	for (std::vector<unsigned char>::const_iterator bufferIter = fileBuffer.begin() + 1; bufferIter != fileBuffer.end(); bufferIter += 2)
+	//Both light channels are kept per face, so only the vertex colors change and nothing is relit or remeshed
+	m_skyLightLevel = skyLightLevel;
+	for (size_t faceIndex = 0; faceIndex < m_faceLightValues.size(); ++faceIndex)
 	{
-		BlockType currentType = (BlockType)*bufferIter;
-		int numBlocksOfCurrentType = (int)*(bufferIter + 1);
-
-		for (int blockIndex = 0; blockIndex < numBlocksOfCurrentType; blockIndex++)
+		unsigned char lightRGBAValue = LIGHT_RGBA_VALUES[CalcVisibleLightValue(m_faceLightValues[faceIndex], m_skyLightLevel)];
+		Rgba lightColor(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255);
+		for (size_t vertexIndex = faceIndex * VERTEXES_PER_FACE; vertexIndex < (faceIndex + 1) * VERTEXES_PER_FACE; ++vertexIndex)
 		{
-			m_blocks[currentBlockIndex].ChangeType(currentType);
-			currentBlockIndex++;
+			m_vertexes[vertexIndex].color = lightColor;
 		}
 	}
+
+	if (!m_vertexes.empty())
+	{
+		UploadVertexBuffer();
+	}
 }
 
-void Chunk::PopulateFromNoise()
+void Chunk::BuildLodVertexArray(std::vector<Vertex3D>& vertexArray, std::vector<unsigned char>& faceLightValues)
 {
-	Vector3 chunkWorldMins = CalcChunkMins();
-
-	constexpr int mountainousnessSize = (CHUNK_X + 8) * (CHUNK_Y + 8);
-	float mountainousness[mountainousnessSize];
-	float mountainousnessAmplitude = 20.f;
-	for (int xIndex = -4; xIndex < CHUNK_X + 4; xIndex++)
+	int cellSize = BIT(m_lodLevel);
+	int numCellsX = CHUNK_X >> m_lodLevel;
+	int numCellsY = CHUNK_Y >> m_lodLevel;
+	int numCellsZ = CHUNK_Z >> m_lodLevel;
+	int cellVolume = cellSize * cellSize * cellSize;
+
+	//Each cell becomes the most common opaque type inside it, or air if less than half of it is opaque
+	std::vector<BlockType> cellTypes(numCellsX * numCellsY * numCellsZ, BLOCK_TYPE_AIR);
+	for (int cellZ = 0; cellZ < numCellsZ; ++cellZ)
 	{
-		for (int yIndex = -4; yIndex < CHUNK_Y + 4; yIndex++)
+		for (int cellY = 0; cellY < numCellsY; ++cellY)
 		{
-			mountainousness[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))] = (mountainousnessAmplitude * Compute2dPerlinNoise(xIndex + chunkWorldMins.x, yIndex + chunkWorldMins.y, 500.f, 5, 0.2f, 2.f, true, 35)) + mountainousnessAmplitude;
+			for (int cellX = 0; cellX < numCellsX; ++cellX)
+			{
+				int typeCounts[NUM_BLOCK_TYPES] = { 0 };
+				int numOpaqueBlocks = 0;
+				BlockType dominantType = BLOCK_TYPE_AIR;
+
+				//Walk down from the top so ties favor the surface type, such as grass over dirt
+				for (int zIndex = ((cellZ + 1) * cellSize) - 1; zIndex >= cellZ * cellSize; --zIndex)
+				{
+					for (int yIndex = cellY * cellSize; yIndex < (cellY + 1) * cellSize; ++yIndex)
+					{
+						for (int xIndex = cellX * cellSize; xIndex < (cellX + 1) * cellSize; ++xIndex)
+						{
+							const Block& block = m_blocks[GetBlockIndexForBlockCoords(IntVector3(xIndex, yIndex, zIndex))];
+							if (!block.GetIsOpaque())
+								continue;
+
+							BlockType blockType = block.GetBlockType();
+							++typeCounts[blockType];
+							++numOpaqueBlocks;
+							if (typeCounts[blockType] > typeCounts[dominantType])
+								dominantType = blockType;
+						}
+					}
+				}
+
+				if (numOpaqueBlocks * 2 >= cellVolume)
+					cellTypes[cellX + (cellY * numCellsX) + (cellZ * numCellsX * numCellsY)] = dominantType;
+			}
 		}
 	}
 
-	constexpr int columnHeightsSize = (CHUNK_X + 8) * (CHUNK_Y + 8);
-	int columnHeights[columnHeightsSize];
-	for (int xIndex = -4; xIndex < CHUNK_X + 4; xIndex++)
+	const Vertex3D* faceVertexes[NUM_SECTION_FACES] = { g_bottomFaceVertexes, g_topFaceVertexes, g_northFaceVertexes, g_southFaceVertexes, g_eastFaceVertexes, g_westFaceVertexes };
+	const IntVector3 faceSteps[NUM_SECTION_FACES] = { IntVector3(0, 0, -1), IntVector3(0, 0, 1), IntVector3(0, 1, 0), IntVector3(0, -1, 0), IntVector3(1, 0, 0), IntVector3(-1, 0, 0) };
+
+	for (int cellZ = 0; cellZ < numCellsZ; ++cellZ)
 	{
-		for (int yIndex = -4; yIndex < CHUNK_Y + 4; yIndex++)
+		for (int cellY = 0; cellY < numCellsY; ++cellY)
 		{
-			float currentColumnHeight = (float)SEA_LEVEL;
-			currentColumnHeight += mountainousness[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))] * Compute2dPerlinNoise(xIndex + chunkWorldMins.x, yIndex + chunkWorldMins.y, 60.f, 5, 0.4f);
-			columnHeights[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))] = (int)currentColumnHeight;
+			for (int cellX = 0; cellX < numCellsX; ++cellX)
+			{
+				BlockType cellType = cellTypes[cellX + (cellY * numCellsX) + (cellZ * numCellsX * numCellsY)];
+				if (cellType == BLOCK_TYPE_AIR)
+					continue;
+
+				const BlockDefinition* cellDefinition = BlockDefinition::s_blockDefinitions[cellType];
+				const int spriteIndexes[NUM_SECTION_FACES] = { cellDefinition->m_bottomSpriteIndex, cellDefinition->m_topSpriteIndex, cellDefinition->m_northSpriteIndex, cellDefinition->m_southSpriteIndex, cellDefinition->m_eastSpriteIndex, cellDefinition->m_westSpriteIndex };
+				IntVector3 cellBlockMins(cellX * cellSize, cellY * cellSize, cellZ * cellSize);
+				Vector3 cellPosition = m_chunkWorldMins + Vector3(cellBlockMins);
+
+				for (int faceIndex = 0; faceIndex < NUM_SECTION_FACES; ++faceIndex)
+				{
+					//Like full resolution meshes, faces on the chunk's border are always kept
+					int neighborX = cellX + faceSteps[faceIndex].x;
+					int neighborY = cellY + faceSteps[faceIndex].y;
+					int neighborZ = cellZ + faceSteps[faceIndex].z;
+					bool isNeighborInChunk = neighborX >= 0 && neighborX < numCellsX && neighborY >= 0 && neighborY < numCellsY && neighborZ >= 0 && neighborZ < numCellsZ;
+					if (isNeighborInChunk && cellTypes[neighborX + (neighborY * numCellsX) + (neighborZ * numCellsX * numCellsY)] != BLOCK_TYPE_AIR)
+						continue;
+
+					unsigned char packedLightValues = CalcLodFaceLightValues(cellBlockMins, cellSize, (SectionFace)faceIndex);
+					AddFaceVertexes(vertexArray, faceLightValues, cellPosition, (float)cellSize, faceVertexes[faceIndex], spriteIndexes[faceIndex], packedLightValues);
+				}
+			}
 		}
 	}
-	
-	constexpr int wetnessSize = (CHUNK_X + 10) * (CHUNK_Y + 10);
-	float wetness[wetnessSize];
-	for (int yIndex = -5; yIndex < CHUNK_Y + 5; yIndex++)
+}
+
+unsigned char Chunk::CalcLodFaceLightValues(const IntVector3& cellBlockMins, int cellSize, SectionFace face)
+{
+	//Brightest non-opaque block in the layer just outside the cell face, for each channel
+	unsigned int brightestSkyLightValue = 0;
+	unsigned int brightestBlockLightValue = 0;
+	for (int firstIndex = 0; firstIndex < cellSize; ++firstIndex)
 	{
-		for (int xIndex = -5; xIndex < CHUNK_X + 5; xIndex++)
+		for (int secondIndex = 0; secondIndex < cellSize; ++secondIndex)
 		{
-			int wetnessIndex = (xIndex + 5) + ((yIndex + 5) * (CHUNK_X + 10));
-			wetness[wetnessIndex] = RangeMapFloat(Compute2dPerlinNoise(xIndex + chunkWorldMins.x, yIndex + chunkWorldMins.y, 40.f, 4, 0.5f, 1.5f, true, 3534879), -1.f, 1.f, 0.f, 2.f);
+			IntVector3 blockCoords = cellBlockMins;
+			switch (face)
+			{
+			case SECTION_FACE_BOTTOM:
+			case SECTION_FACE_TOP:
+				blockCoords.x += firstIndex;
+				blockCoords.y += secondIndex;
+				blockCoords.z += (face == SECTION_FACE_TOP) ? cellSize - 1 : 0;
+				break;
+			case SECTION_FACE_NORTH:
+			case SECTION_FACE_SOUTH:
+				blockCoords.x += firstIndex;
+				blockCoords.z += secondIndex;
+				blockCoords.y += (face == SECTION_FACE_NORTH) ? cellSize - 1 : 0;
+				break;
+			default:
+				blockCoords.y += firstIndex;
+				blockCoords.z += secondIndex;
+				blockCoords.x += (face == SECTION_FACE_EAST) ? cellSize - 1 : 0;
+				break;
+			}
+
+			BlockInfo cellBlock(this, GetBlockIndexForBlockCoords(blockCoords));
+			BlockInfo outsideBlock;
+			switch (face)
+			{
+			case SECTION_FACE_BOTTOM:	outsideBlock = cellBlock.GetBelowBlock();	break;
+			case SECTION_FACE_TOP:		outsideBlock = cellBlock.GetAboveBlock();	break;
+			case SECTION_FACE_NORTH:	outsideBlock = cellBlock.GetNorthBlock();	break;
+			case SECTION_FACE_SOUTH:	outsideBlock = cellBlock.GetSouthBlock();	break;
+			case SECTION_FACE_EAST:		outsideBlock = cellBlock.GetEastBlock();	break;
+			default:					outsideBlock = cellBlock.GetWestBlock();	break;
+			}
+
+			if (!outsideBlock.m_chunk)
+				return PackLightValues(SKY_LIGHT_VALUE, 0);
+
+			const Block* block = outsideBlock.GetBlock();
+			if (block->GetIsOpaque())
+				continue;
+			if (block->GetLightValue(LIGHT_CHANNEL_SKY) > brightestSkyLightValue)
+				brightestSkyLightValue = block->GetLightValue(LIGHT_CHANNEL_SKY);
+			if (block->GetLightValue(LIGHT_CHANNEL_BLOCK) > brightestBlockLightValue)
+				brightestBlockLightValue = block->GetLightValue(LIGHT_CHANNEL_BLOCK);
 		}
 	}
 
-	constexpr int temperatureSize = (CHUNK_X + 8) * (CHUNK_Y + 8);
-	float temperature[temperatureSize];
-	for (int xIndex = -4; xIndex < CHUNK_X + 4; xIndex++)
+	return PackLightValues(brightestSkyLightValue, brightestBlockLightValue);
+}
+
+unsigned char Chunk::GetFaceLightValues(const BlockInfo& facingNeighbor) const
+{
+	if (!facingNeighbor.m_chunk)
+		return PackLightValues(SKY_LIGHT_VALUE, 0);
+	return facingNeighbor.GetBlock()->GetPackedLightValues();
+}
+
+void Chunk::AddFaceVertexes(std::vector<Vertex3D>& vertexArray, std::vector<unsigned char>& faceLightValues, const Vector3& position, float faceSize, const Vertex3D* faceVertexes, int spriteIndex, unsigned char packedLightValues)
+{
+	AABB2 texCoords = g_blockSprites->GetTexCoordsForSpriteIndex(spriteIndex);
+	unsigned char lightRGBAValue = LIGHT_RGBA_VALUES[CalcVisibleLightValue(packedLightValues, m_skyLightLevel)];
+	Rgba lightColor(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255);
+	faceLightValues.push_back(packedLightValues);
+
+	for (int cornerIndex = 0; cornerIndex < VERTEXES_PER_FACE; ++cornerIndex)
 	{
-		for (int yIndex = -4; yIndex < CHUNK_Y + 4; yIndex++)
-		{
-			temperature[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))] = RangeMapFloat(Compute2dPerlinNoise(xIndex + chunkWorldMins.x, yIndex + chunkWorldMins.y, 500.f, 5, 0.4f, 2.f, true, 543253), -1.f, 1.f, 0.f, 100.f);
-		}
+		const Vector2& corner = faceVertexes[cornerIndex].texCoords;
+		Vector2 cornerTexCoords(corner.x > 0.f ? texCoords.maxs.x : texCoords.mins.x, corner.y > 0.f ? texCoords.maxs.y : texCoords.mins.y);
+		vertexArray.push_back(Vertex3D(position + (faceVertexes[cornerIndex].position * faceSize), cornerTexCoords, lightColor));
 	}
+}
 
+void Chunk::CalculateSectionConnectivity()
+{
+	unsigned char isVisited[BLOCKS_PER_SECTION];
+	int floodStack[BLOCKS_PER_SECTION];
 
-	constexpr int treeValuesSize = (CHUNK_X + 10) * (CHUNK_Y + 10);
-	float treeValues[treeValuesSize];
-	for (int yIndex = -5; yIndex < CHUNK_Y + 5; yIndex++)
+	for (int sectionIndex = 0; sectionIndex < SECTIONS_PER_CHUNK; ++sectionIndex)
 	{
-		for (int xIndex = -5; xIndex < CHUNK_X + 5; xIndex++)
+		unsigned char previousConnectivity[NUM_SECTION_FACES];
+		for (int faceIndex = 0; faceIndex < NUM_SECTION_FACES; ++faceIndex)
 		{
-			float octaveScale = wetness[(xIndex + 5) + ((yIndex + 5) * (CHUNK_X + 10))];
-			treeValues[(xIndex + 5) + ((yIndex + 5) * (CHUNK_X + 10))] = Compute2dPerlinNoise(xIndex + chunkWorldMins.x, yIndex + chunkWorldMins.y, 100.f, 5, 0.2f, octaveScale, true, 1);
+			previousConnectivity[faceIndex] = m_sectionConnectivity[sectionIndex][faceIndex];
+			m_sectionConnectivity[sectionIndex][faceIndex] = 0;
 		}
-	}
 
-	for (int zIndex = 0; zIndex < CHUNK_Z; zIndex++)
-	{
-		for (int yIndex = 0; yIndex < CHUNK_Y; yIndex++)
+		int sectionFirstBlockIndex = sectionIndex * BLOCKS_PER_SECTION;
+		for (int localIndex = 0; localIndex < BLOCKS_PER_SECTION; ++localIndex)
 		{
-			for (int xIndex = 0; xIndex < CHUNK_X; xIndex++)
+			isVisited[localIndex] = m_blocks[sectionFirstBlockIndex + localIndex].GetIsOpaque() ? 1 : 0;
+		}
+
+		//Flood fill each pocket of non-opaque blocks, and connect every pair of faces the pocket touches
+		for (int seedIndex = 0; seedIndex < BLOCKS_PER_SECTION; ++seedIndex)
+		{
+			if (isVisited[seedIndex])
+				continue;
+
+			unsigned char touchedFaces = 0;
+			int stackSize = 0;
+			floodStack[stackSize++] = seedIndex;
+			isVisited[seedIndex] = 1;
+
+			while (stackSize > 0)
 			{
-				int columnHeight = columnHeights[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))];
-				float blockWetness = wetness[(xIndex + 5) + ((yIndex + 5) * (CHUNK_X + 10))];
-				float blockTemperature = temperature[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))];
+				int localIndex = floodStack[--stackSize];
+				int xIndex = localIndex & X_MASK_BITS;
+				int yIndex = (localIndex & Y_MASK_BITS) >> CHUNK_X_BITS;
+				int zIndex = localIndex >> CHUNK_XY_BITS;
+
+				if (xIndex == 0)
+					touchedFaces |= BIT(SECTION_FACE_WEST);
+				else if (!isVisited[localIndex - 1])
+				{
+					isVisited[localIndex - 1] = 1;
+					floodStack[stackSize++] = localIndex - 1;
+				}
 
-				if (zIndex < columnHeight + STONE_OFFSET)
+				if (xIndex == CHUNK_X - 1)
+					touchedFaces |= BIT(SECTION_FACE_EAST);
+				else if (!isVisited[localIndex + 1])
 				{
-					m_blocks[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)].ChangeType(BLOCK_TYPE_STONE);
+					isVisited[localIndex + 1] = 1;
+					floodStack[stackSize++] = localIndex + 1;
 				}
-				else if (zIndex < columnHeight + DIRT_OFFSET)
+
+				if (yIndex == 0)
+					touchedFaces |= BIT(SECTION_FACE_SOUTH);
+				else if (!isVisited[localIndex - CHUNK_X])
 				{
-					if (zIndex <= SEA_LEVEL || (blockWetness < DESERT_WETNESS_MAXIMUM && blockTemperature > DESERT_TEMPERATURE_MINIMUM))
-						m_blocks[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)].ChangeType(BLOCK_TYPE_SAND);
-					else
-						m_blocks[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)].ChangeType(BLOCK_TYPE_DIRT);
+					isVisited[localIndex - CHUNK_X] = 1;
+					floodStack[stackSize++] = localIndex - CHUNK_X;
 				}
-				else if (zIndex < columnHeight + GRASS_OFFSET)
+
+				if (yIndex == CHUNK_Y - 1)
+					touchedFaces |= BIT(SECTION_FACE_NORTH);
+				else if (!isVisited[localIndex + CHUNK_X])
 				{
-					if (zIndex <= SEA_LEVEL || (blockWetness < DESERT_WETNESS_MAXIMUM && blockTemperature > DESERT_TEMPERATURE_MINIMUM))
-						m_blocks[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)].ChangeType(BLOCK_TYPE_SAND);
-					else if(blockTemperature < SNOW_TEMPERATURE_MAXIMUM)
-						m_blocks[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)].ChangeType(BLOCK_TYPE_SNOW);
-					else
-						m_blocks[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)].ChangeType(BLOCK_TYPE_GRASS);
+					isVisited[localIndex + CHUNK_X] = 1;
+					floodStack[stackSize++] = localIndex + CHUNK_X;
 				}
-				else
+
+				if (zIndex == 0)
+					touchedFaces |= BIT(SECTION_FACE_BOTTOM);
+				else if (!isVisited[localIndex - BLOCKS_PER_LAYER])
 				{
-					if (zIndex <= SEA_LEVEL)
-						m_blocks[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)].ChangeType(BLOCK_TYPE_WATER);
-					else
-						m_blocks[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)].ChangeType(BLOCK_TYPE_AIR);
+					isVisited[localIndex - BLOCKS_PER_LAYER] = 1;
+					floodStack[stackSize++] = localIndex - BLOCKS_PER_LAYER;
+				}
+
+				if (zIndex == CHUNK_SECTION_Z - 1)
+					touchedFaces |= BIT(SECTION_FACE_TOP);
+				else if (!isVisited[localIndex + BLOCKS_PER_LAYER])
+				{
+					isVisited[localIndex + BLOCKS_PER_LAYER] = 1;
+					floodStack[stackSize++] = localIndex + BLOCKS_PER_LAYER;
+				}
+			}
+
+			for (int faceIndex = 0; faceIndex < NUM_SECTION_FACES; ++faceIndex)
+			{
+				if (touchedFaces & BIT(faceIndex))
+				{
+					m_sectionConnectivity[sectionIndex][faceIndex] |= touchedFaces;
 				}
 			}
 		}
-	}
 
-	for (int xIndex = -4; xIndex < CHUNK_X + 4; xIndex++)
-	{
-		for (int yIndex = -4; yIndex < CHUNK_Y + 4; yIndex++)
+		for (int faceIndex = 0; faceIndex < NUM_SECTION_FACES; ++faceIndex)
 		{
-			int columnHeight = (columnHeights[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))] + GRASS_OFFSET);
-			if (IsLocalMaxima(treeValues, ((xIndex + 5) + ((yIndex + 5) * (CHUNK_X + 10))), treeValuesSize, CHUNK_X + 10) && columnHeight > SEA_LEVEL)
+			if (previousConnectivity[faceIndex] != m_sectionConnectivity[sectionIndex][faceIndex])
 			{
-				Vector3 startPosition(m_chunkWorldMins.x + xIndex, m_chunkWorldMins.y + yIndex, (float)columnHeight);
-				if(temperature[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))] > 80.f)
-					PlaceTreeBlocks(startPosition, *TreeDefinition::s_treeDefinitions[TREE_TYPE_WIMBA]);
-				else if(temperature[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))] > 60.f)
-					PlaceTreeBlocks(startPosition, *TreeDefinition::s_treeDefinitions[TREE_TYPE_WILLOW]);
-				else if (temperature[(xIndex + 4) + ((yIndex + 4) * (CHUNK_X + 8))] > 40.f)
-					PlaceTreeBlocks(startPosition, *TreeDefinition::s_treeDefinitions[TREE_TYPE_OAK]);
-				else
-					PlaceTreeBlocks(startPosition, *TreeDefinition::s_treeDefinitions[TREE_TYPE_PINE]);
+				m_hasConnectivityChanged = true;
 			}
 		}
 	}
 }
 
+void Chunk::GenerateChunk(const TerrainGenerator& generator, TerrainColumnCache& columnCache, std::vector<DecorationWrite>& out_outsideWrites, GenerationProfile* profile)
+{
+	std::vector<unsigned char> fileBuffer;
+	std::string filePath = GetSaveFilePath(m_chunkCoords);
+	if (ReadBufferFromFile(fileBuffer, filePath) && IsSaveFileCurrent(fileBuffer))
+	{
+		PopulateFromFile(fileBuffer);
+	}
+	else
+	{
+		PopulateFromNoise(generator, columnCache, out_outsideWrites, profile);
+	}
+}
+
+void Chunk::ApplyGeneratedDecorationWrites(const std::vector<DecorationWrite>& writes)
+{
+	//Only for a chunk that was just filled, before it is lit, edits to a lit chunk go through the world
+	for (size_t writeIndex = 0; writeIndex < writes.size(); ++writeIndex)
+	{
+		Block& block = m_blocks[writes[writeIndex].m_blockIndex];
+		if (CanDecorationReplace(block.GetBlockType(), writes[writeIndex].m_blockType))
+			block.ChangeType(writes[writeIndex].m_blockType);
+	}
+}
+
+void Chunk::BuildTypeBlocks(Block* out_typeBlocks)
+{
+	for (int typeIndex = 0; typeIndex < NUM_BLOCK_TYPES; ++typeIndex)
+	{
+		out_typeBlocks[typeIndex].ChangeType((BlockType)typeIndex);
+	}
+}
+
+void Chunk::PopulateFromFile(const std::vector<unsigned char>& fileBuffer)
+{
+	ASSERT_OR_DIE(fileBuffer[0] == g_GAME_VERSION, "Chunk file version mismatch");
+
+	Block typeBlocks[NUM_BLOCK_TYPES];
+	BuildTypeBlocks(typeBlocks);
+
+	int currentBlockIndex = 0;
+	for (std::vector<unsigned char>::const_iterator bufferIter = fileBuffer.begin() + 1; bufferIter != fileBuffer.end(); bufferIter += 2)
+	{
+		Block currentBlock = typeBlocks[*bufferIter];
+		int numBlocksOfCurrentType = (int)*(bufferIter + 1);
+
+		for (int blockIndex = 0; blockIndex < numBlocksOfCurrentType; blockIndex++)
+		{
+			m_blocks[currentBlockIndex] = currentBlock;
+			currentBlockIndex++;
+		}
+	}
+}
+
+void Chunk::PopulateFromNoise(const TerrainGenerator& generator, TerrainColumnCache& columnCache, std::vector<DecorationWrite>& out_outsideWrites, GenerationProfile* profile)
+{
+	std::vector<BlockType> blockTypes(BLOCKS_PER_CHUNK);
+	generator.GenerateChunk(m_chunkCoords, columnCache, blockTypes.data(), out_outsideWrites, profile);
+
+	//Copy finished blocks instead of looking each definition up again, a new chunk has no lighting to keep
+	Block typeBlocks[NUM_BLOCK_TYPES];
+	BuildTypeBlocks(typeBlocks);
+	for (int blockIndex = 0; blockIndex < BLOCKS_PER_CHUNK; ++blockIndex)
+	{
+		m_blocks[blockIndex] = typeBlocks[blockTypes[blockIndex]];
+	}
+}
+
+void Chunk::CalculateSkyHeights()
+{
+	for (int columnIndex = 0; columnIndex < BLOCKS_PER_LAYER; ++columnIndex)
+	{
+		int skyHeight = CHUNK_Z;
+		while (skyHeight > 0 && !m_blocks[columnIndex + ((skyHeight - 1) << CHUNK_XY_BITS)].GetIsOpaque())
+		{
+			--skyHeight;
+		}
+		m_skyHeights[columnIndex] = (unsigned char)skyHeight;
+	}
+}
+
 void Chunk::InitializeLighting()
 {
 	for (int blockIndex = 0; blockIndex < BLOCKS_PER_CHUNK; ++blockIndex)
@@ -416,85 +579,156 @@ void Chunk::InitializeLighting()
 		}
 	}
 
-	//Create sky
-	for (int xIndex = 0; xIndex < CHUNK_X; ++xIndex)
+	//Light the sky and everything it reaches sideways in bulk, only the vertical frontier is left for the flood fill
+	CalculateSkyHeights();
+	FillSkyLight();
+
+	//Stitch light across the borders with loaded neighbors, a neighbor loaded later stitches the shared border from its side
+	for (int zIndex = 0; zIndex < CHUNK_Z; ++zIndex)
 	{
-		for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+		for (int edgeIndex = 0; edgeIndex < CHUNK_Y; ++edgeIndex)
 		{
-			for (int zIndex = CHUNK_Z - 1; zIndex >= 0; --zIndex)
-			{
-				int blockIndex = GetBlockIndexForBlockCoords(IntVector3(xIndex, yIndex, zIndex));
-				if (m_blocks[blockIndex].GetIsOpaque())
-				{
-					break;
-				}
+			if (m_eastNeighbor)
+				StitchBorderLighting(BlockInfo(this, GetBlockIndexForBlockCoords(IntVector3(CHUNK_X - 1, edgeIndex, zIndex))), BlockInfo(m_eastNeighbor, GetBlockIndexForBlockCoords(IntVector3(0, edgeIndex, zIndex))));
+			if (m_westNeighbor)
+				StitchBorderLighting(BlockInfo(this, GetBlockIndexForBlockCoords(IntVector3(0, edgeIndex, zIndex))), BlockInfo(m_westNeighbor, GetBlockIndexForBlockCoords(IntVector3(CHUNK_X - 1, edgeIndex, zIndex))));
+		}
 
-				m_blocks[blockIndex].SetIsSky();
-				m_blocks[blockIndex].SetLightValue(SKY_LIGHT_VALUE);
-			}
+		for (int edgeIndex = 0; edgeIndex < CHUNK_X; ++edgeIndex)
+		{
+			if (m_northNeighbor)
+				StitchBorderLighting(BlockInfo(this, GetBlockIndexForBlockCoords(IntVector3(edgeIndex, CHUNK_Y - 1, zIndex))), BlockInfo(m_northNeighbor, GetBlockIndexForBlockCoords(IntVector3(edgeIndex, 0, zIndex))));
+			if (m_southNeighbor)
+				StitchBorderLighting(BlockInfo(this, GetBlockIndexForBlockCoords(IntVector3(edgeIndex, 0, zIndex))), BlockInfo(m_southNeighbor, GetBlockIndexForBlockCoords(IntVector3(edgeIndex, CHUNK_Y - 1, zIndex))));
 		}
 	}
+}
 
-	//Dirty adjacent non-sky blocks
-	for (int xIndex = 0; xIndex < CHUNK_X; ++xIndex)
+void Chunk::FillSkyLight()
+{
+	static_assert(CHUNK_X <= 16, "Sky light rows are 16 bit masks");
+	const unsigned short FULL_ROW = (unsigned short)(BIT(CHUNK_X) - 1);
+
+	int lowestSkyHeight = CHUNK_Z;
+	int highestSkyHeight = 0;
+	for (int columnIndex = 0; columnIndex < BLOCKS_PER_LAYER; ++columnIndex)
 	{
+		if (m_skyHeights[columnIndex] < lowestSkyHeight)
+			lowestSkyHeight = m_skyHeights[columnIndex];
+		if (m_skyHeights[columnIndex] > highestSkyHeight)
+			highestSkyHeight = m_skyHeights[columnIndex];
+	}
+
+	//Layers at or above every column's sky height are all sky
+	for (int blockIndex = highestSkyHeight << CHUNK_XY_BITS; blockIndex < BLOCKS_PER_CHUNK; ++blockIndex)
+	{
+		m_blocks[blockIndex].SetLightValue(LIGHT_CHANNEL_SKY, SKY_LIGHT_VALUE);
+	}
+
+	//Layers the sky only partly reaches spread it sideways one light level per step, a row of blocks per mask
+	unsigned short spreadRows[CHUNK_Z][CHUNK_Y] = {};
+	for (int zIndex = lowestSkyHeight; zIndex < highestSkyHeight; ++zIndex)
+	{
+		int layerStart = zIndex << CHUNK_XY_BITS;
+		unsigned short openRows[CHUNK_Y];
+		unsigned short litRows[CHUNK_Y];
+		unsigned short frontierRows[CHUNK_Y];
 		for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
 		{
-			for (int zIndex = CHUNK_Z - 1; zIndex >= 0; --zIndex)
+			openRows[yIndex] = 0;
+			litRows[yIndex] = 0;
+			for (int xIndex = 0; xIndex < CHUNK_X; ++xIndex)
 			{
-				int blockIndex = GetBlockIndexForBlockCoords(IntVector3(xIndex, yIndex, zIndex));
-				if (m_blocks[blockIndex].GetIsOpaque())
+				int columnIndex = xIndex + (yIndex << CHUNK_X_BITS);
+				if (zIndex >= m_skyHeights[columnIndex])
 				{
-					break;
+					litRows[yIndex] |= BIT(xIndex);
+					m_blocks[layerStart + columnIndex].SetLightValue(LIGHT_CHANNEL_SKY, SKY_LIGHT_VALUE);
 				}
+				else if (!m_blocks[layerStart + columnIndex].GetIsOpaque())
+				{
+					openRows[yIndex] |= BIT(xIndex);
+				}
+			}
+			frontierRows[yIndex] = litRows[yIndex];
+		}
 
-				BlockInfo blockInfo(this, blockIndex);
-
-				BlockInfo northNeighbor = blockInfo.GetNorthBlock();
-				BlockInfo southNeighbor = blockInfo.GetSouthBlock();
-				BlockInfo eastNeighbor = blockInfo.GetEastBlock();
-				BlockInfo westNeighbor = blockInfo.GetWestBlock();
-
-				if(northNeighbor.GetBlock() && !northNeighbor.GetBlock()->GetIsSky() && !northNeighbor.GetBlock()->GetIsOpaque())
-					g_theApp->m_game->m_theWorld->DirtyBlockLighting(northNeighbor);
-
-				if (southNeighbor.GetBlock() && !southNeighbor.GetBlock()->GetIsSky() && !southNeighbor.GetBlock()->GetIsOpaque())
-					g_theApp->m_game->m_theWorld->DirtyBlockLighting(southNeighbor);
+		for (unsigned int lightValue = SKY_LIGHT_VALUE - 1; lightValue > 0; --lightValue)
+		{
+			bool hasSpread = false;
+			unsigned short nextFrontierRows[CHUNK_Y];
+			for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+			{
+				unsigned short reachedRow = (unsigned short)((frontierRows[yIndex] << 1) | (frontierRows[yIndex] >> 1));
+				if (yIndex > 0)
+					reachedRow |= frontierRows[yIndex - 1];
+				if (yIndex < CHUNK_Y - 1)
+					reachedRow |= frontierRows[yIndex + 1];
+
+				nextFrontierRows[yIndex] = reachedRow & openRows[yIndex] & ~litRows[yIndex] & FULL_ROW;
+				hasSpread = hasSpread || nextFrontierRows[yIndex] != 0;
+			}
 
-				if (eastNeighbor.GetBlock() && !eastNeighbor.GetBlock()->GetIsSky() && !eastNeighbor.GetBlock()->GetIsOpaque())
-					g_theApp->m_game->m_theWorld->DirtyBlockLighting(eastNeighbor);
+			if (!hasSpread)
+				break;
 
-				if (westNeighbor.GetBlock() && !westNeighbor.GetBlock()->GetIsSky() && !westNeighbor.GetBlock()->GetIsOpaque())
-					g_theApp->m_game->m_theWorld->DirtyBlockLighting(westNeighbor);
+			for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+			{
+				frontierRows[yIndex] = nextFrontierRows[yIndex];
+				litRows[yIndex] |= frontierRows[yIndex];
+				spreadRows[zIndex][yIndex] |= frontierRows[yIndex];
+				for (unsigned short row = frontierRows[yIndex]; row != 0; row &= row - 1)
+				{
+					int xIndex = CountTrailingZeros(row);
+					m_blocks[layerStart + xIndex + (yIndex << CHUNK_X_BITS)].SetLightValue(LIGHT_CHANNEL_SKY, lightValue);
+				}
 			}
 		}
 	}
 
-	//Dirty non-opaque blocks on edges
-	//East-west edges
-	for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+	//Sideways spread is complete within the chunk, so only blocks that can still light the layer above or below need flooding
+	for (int zIndex = lowestSkyHeight; zIndex < highestSkyHeight; ++zIndex)
 	{
-		for (int zIndex = 0; zIndex < CHUNK_Z; ++zIndex)
+		for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
 		{
-			BlockInfo eastEdge(this, GetBlockIndexForBlockCoords(IntVector3(CHUNK_X - 1, yIndex, zIndex)));
-			BlockInfo westEdge(this, GetBlockIndexForBlockCoords(IntVector3(0, yIndex, zIndex)));
+			for (unsigned short row = spreadRows[zIndex][yIndex]; row != 0; row &= row - 1)
+			{
+				int blockIndex = CountTrailingZeros(row) + (yIndex << CHUNK_X_BITS) + (zIndex << CHUNK_XY_BITS);
+				unsigned int lightValue = m_blocks[blockIndex].GetLightValue(LIGHT_CHANNEL_SKY);
+				if (lightValue <= 1)
+					continue;
 
-			g_theApp->m_game->m_theWorld->DirtyBlockLighting(eastEdge);
-			g_theApp->m_game->m_theWorld->DirtyBlockLighting(westEdge);
+				bool isFrontier = false;
+				if (zIndex > 0)
+				{
+					const Block& belowBlock = m_blocks[blockIndex - BLOCKS_PER_LAYER];
+					isFrontier = !belowBlock.GetIsOpaque() && belowBlock.GetLightValue(LIGHT_CHANNEL_SKY) < lightValue - 1;
+				}
+				if (zIndex < CHUNK_Z - 1 && !isFrontier)
+				{
+					const Block& aboveBlock = m_blocks[blockIndex + BLOCKS_PER_LAYER];
+					isFrontier = !aboveBlock.GetIsOpaque() && aboveBlock.GetLightValue(LIGHT_CHANNEL_SKY) < lightValue - 1;
+				}
+
+				if (isFrontier)
+					g_theApp->m_game->m_theWorld->QueueLightAddition(BlockInfo(this, blockIndex), LIGHT_CHANNEL_SKY);
+			}
 		}
 	}
+}
 
-	//North-south edges
-	for (int xIndex = 0; xIndex < CHUNK_Y; ++xIndex)
+void Chunk::StitchBorderLighting(BlockInfo edgeBlock, BlockInfo neighborBlock)
+{
+	//Light only still has to flow where the levels across the border differ by more than one, and only into a non-opaque block
+	for (int channelIndex = 0; channelIndex < NUM_LIGHT_CHANNELS; ++channelIndex)
 	{
-		for (int zIndex = 0; zIndex < CHUNK_Z; ++zIndex)
-		{
-			BlockInfo northEdge(this, GetBlockIndexForBlockCoords(IntVector3(xIndex, CHUNK_Y - 1, zIndex)));
-			BlockInfo southEdge(this, GetBlockIndexForBlockCoords(IntVector3(xIndex, 0, zIndex)));
+		unsigned int edgeLightValue = edgeBlock.GetBlock()->GetLightValue((LightChannel)channelIndex);
+		unsigned int neighborLightValue = neighborBlock.GetBlock()->GetLightValue((LightChannel)channelIndex);
 
-			g_theApp->m_game->m_theWorld->DirtyBlockLighting(northEdge);
-			g_theApp->m_game->m_theWorld->DirtyBlockLighting(southEdge);
-		}
+		if (neighborLightValue > edgeLightValue + 1 && !edgeBlock.GetBlock()->GetIsOpaque())
+			g_theApp->m_game->m_theWorld->DirtyBlockLighting(edgeBlock);
+		else if (edgeLightValue > neighborLightValue + 1 && !neighborBlock.GetBlock()->GetIsOpaque())
+			g_theApp->m_game->m_theWorld->DirtyBlockLighting(neighborBlock);
 	}
 }
 
@@ -502,11 +736,32 @@ bool Chunk::SaveToFile()
 {
 	std::vector<unsigned char> chunkBuffer;
 	CompressToRLE(chunkBuffer);
-	std::string filePath = "Data/Save/Chunk_(" + std::to_string(m_chunkCoords.x) + "," + std::to_string(m_chunkCoords.y) + ").cnk";
+	std::string filePath = GetSaveFilePath(m_chunkCoords);
 	return WriteBufferToFile(chunkBuffer, filePath);
 }
 
 void Chunk::CompressToRLE(std::vector<unsigned char>& out_chunkBuffer)
+{
+	BlockType blockTypes[BLOCKS_PER_CHUNK];
+	for (int blockIndex = 0; blockIndex < BLOCKS_PER_CHUNK; blockIndex++)
+	{
+		blockTypes[blockIndex] = m_blocks[blockIndex].GetBlockType();
+	}
+	CompressBlockTypesToRLE(blockTypes, out_chunkBuffer);
+}
+
+std::string Chunk::GetSaveFilePath(const IntVector2& chunkCoords)
+{
+	return "Data/Save/Chunk_(" + std::to_string(chunkCoords.x) + "," + std::to_string(chunkCoords.y) + ").cnk";
+}
+
+bool Chunk::IsSaveFileCurrent(const std::vector<unsigned char>& fileBuffer)
+{
+	//Chunks saved by an earlier version were generated differently and are regenerated rather than mixed in
+	return !fileBuffer.empty() && fileBuffer[0] == g_GAME_VERSION;
+}
+
+void Chunk::CompressBlockTypesToRLE(const BlockType* blockTypes, std::vector<unsigned char>& out_chunkBuffer)
 {
 	out_chunkBuffer.reserve(BLOCKS_PER_LAYER);
 
@@ -516,7 +771,7 @@ void Chunk::CompressToRLE(std::vector<unsigned char>& out_chunkBuffer)
 	int numCurrentBlockType = 0;
 	for (int blockIndex = 0; blockIndex < BLOCKS_PER_CHUNK; blockIndex++)
 	{
-		if (m_blocks[blockIndex].GetBlockType() == currentType)
+		if (blockTypes[blockIndex] == currentType)
 		{
 			numCurrentBlockType++;
 		}
@@ -524,7 +779,7 @@ void Chunk::CompressToRLE(std::vector<unsigned char>& out_chunkBuffer)
 		{
 			out_chunkBuffer.push_back((unsigned char)currentType);
 			out_chunkBuffer.push_back((unsigned char)numCurrentBlockType);
-			currentType = m_blocks[blockIndex].GetBlockType();
+			currentType = blockTypes[blockIndex];
 			numCurrentBlockType = 1;
 		}
 
@@ -537,73 +792,4 @@ void Chunk::CompressToRLE(std::vector<unsigned char>& out_chunkBuffer)
 	}
 }
 
-bool Chunk::IsLocalMaxima(float* arrayValues, int indexInArray, int numValues, int xDimension) const
-{
-	float valueToCheck = arrayValues[indexInArray];
-
-	int northIndex = indexInArray + xDimension;
-	if (northIndex > 0 && northIndex < numValues && valueToCheck < arrayValues[northIndex])
-	{
-		return false;
-	}
-
-	int northEastIndex = indexInArray + xDimension + 1;
-	if (northEastIndex > 0 && northEastIndex < numValues && valueToCheck < arrayValues[northEastIndex])
-	{
-		return false;
-	}
-
-	int eastIndex = indexInArray + 1;
-	if (eastIndex > 0 && eastIndex < numValues && valueToCheck < arrayValues[eastIndex])
-	{
-		return false;
-	}
-
-	int southEastIndex = indexInArray - xDimension + 1;
-	if (southEastIndex > 0 && southEastIndex < numValues && valueToCheck < arrayValues[southEastIndex])
-	{
-		return false;
-	}
-
-	int southIndex = indexInArray - xDimension;
-	if (southIndex > 0 && southIndex < numValues && valueToCheck < arrayValues[southIndex])
-	{
-		return false;
-	}
-
-	int southWestIndex = (indexInArray - xDimension) - 1;
-	if (southWestIndex > 0 && southWestIndex < numValues && valueToCheck < arrayValues[southWestIndex])
-	{
-		return false;
-	}
-
-	int westIndex = indexInArray - 1;
-	if (westIndex > 0 && westIndex < numValues && valueToCheck < arrayValues[westIndex])
-	{
-		return false;
-	}
-
-	int northWestIndex = indexInArray + xDimension - 1;
-	if (northWestIndex > 0 && northWestIndex < numValues && valueToCheck < arrayValues[northWestIndex])
-	{
-		return false;
-	}
-
-	return true;
-}
-
-void Chunk::PlaceTreeBlocks(const Vector3& worldStartPosition, TreeDefinition treeToPlace)
-{
-	BlockInfo currentBlock;
-
-	for (size_t treeBlockIndex = 0; treeBlockIndex < treeToPlace.GetTreeBlocks().size(); treeBlockIndex++)
-	{
-		currentBlock = g_theApp->m_game->m_theWorld->GetBlockInfoFromWorldCoords(worldStartPosition + treeToPlace.GetTreeBlocks()[treeBlockIndex].offsetFromBase);
-		if (currentBlock.m_chunk == this && (currentBlock.GetBlock()->GetBlockType() == BLOCK_TYPE_AIR || currentBlock.GetBlock()->GetBlockType() == BLOCK_TYPE_LEAVES))
-		{
-			currentBlock.ChangeType(treeToPlace.GetTreeBlocks()[treeBlockIndex].blockType);
-		}
-	}
-}
-
 
@@ -3,10 +3,32 @@
 #include "Game/GameCommon.hpp"
 #include "Engine/Math/Vector3.hpp"
 #include "Engine/Math/IntVector2.hpp"
-#include "Game/TreeDefinition.hpp"
+#include "Game/TerrainGenerator.hpp"
+#include <string>
 #include <vector>
 
 
+class BlockInfo;
+class RecordingRenderer;
+
+
+enum SectionFace
+{
+	SECTION_FACE_BOTTOM,
+	SECTION_FACE_TOP,
+	SECTION_FACE_NORTH,
+	SECTION_FACE_SOUTH,
+	SECTION_FACE_EAST,
+	SECTION_FACE_WEST,
+	NUM_SECTION_FACES,
+	SECTION_FACE_NONE = NUM_SECTION_FACES
+};
+
+inline SectionFace GetOppositeSectionFace(SectionFace face)
+{
+	return (SectionFace)(face ^ 1);
+}
+
 
 class Chunk
 {
@@ -28,38 +50,67 @@ private:
 	Vector3 m_bottomSouthWestCorner;
 
 	Block m_blocks[BLOCKS_PER_CHUNK];
+	unsigned char m_skyHeights[BLOCKS_PER_LAYER];		//per column, the lowest z open to the sky (one above the highest opaque block)
+
+	std::vector<Vertex3D> m_vertexes;		//world space mesh, kept so a sky level change can recolor it without remeshing
+	std::vector<unsigned char> m_faceLightValues;		//packed sky and block light for each face in m_vertexes
 
 	unsigned int m_vboID;
 	unsigned int m_numVertexesInVBO;
 
+	int m_lodLevel;		//mesh downsampling, each cell covers BIT(m_lodLevel) blocks per axis
+	int m_lightingSlot;		//index light queue entries use to refer to this chunk, -1 when inactive
+	unsigned int m_skyLightLevel;		//sky brightness the vertex colors were last computed for
+
+	unsigned char m_sectionConnectivity[SECTIONS_PER_CHUNK][NUM_SECTION_FACES];		//for each section and entry face, a bitmask of the faces reachable through non-opaque blocks
+
 	Chunk* m_northNeighbor;
 	Chunk* m_southNeighbor;
 	Chunk* m_eastNeighbor;
 	Chunk* m_westNeighbor;
 
 	const Vector3 CalcChunkMins() const;
-	bool IsLocalMaxima(float* arrayValues, int indexInArray, int numValues, int xDimension) const;
-	void PlaceTreeBlocks(const Vector3& worldStartPosition, TreeDefinition treeToPlace);
+	void CalculateSectionConnectivity();
+	void FinishVertexArray(std::vector<Vertex3D>& vertexArray, std::vector<unsigned char>& faceLightValues);
+	void BuildLodVertexArray(std::vector<Vertex3D>& vertexArray, std::vector<unsigned char>& faceLightValues);
+	unsigned char CalcLodFaceLightValues(const IntVector3& cellBlockMins, int cellSize, SectionFace face);
+	unsigned char GetFaceLightValues(const BlockInfo& facingNeighbor) const;
+	void FillSkyLight();
+	void StitchBorderLighting(BlockInfo edgeBlock, BlockInfo neighborBlock);
+	void AddFaceVertexes(std::vector<Vertex3D>& vertexArray, std::vector<unsigned char>& faceLightValues, const Vector3& position, float faceSize, const Vertex3D* faceVertexes, int spriteIndex, unsigned char packedLightValues);
+	void UploadVertexBuffer();
 public:
 	bool m_isVBODirty;
+	bool m_hasConnectivityChanged;
+
+	int m_frustumFrameNumber;
+	int m_drawnFrameNumber;
+	int m_sectionVisitedFrameNumbers[SECTIONS_PER_CHUNK];
 
 	Chunk();
 	Chunk(const IntVector2& chunkCoords);
 	~Chunk();
 
 	void Update(float deltaSeconds);
-	void Render() const;
+	void Render(RecordingRenderer& renderer) const;
 
 	void RebuildVertexArray();
+	void ApplySkyLightLevel(unsigned int skyLightLevel);
 
-	void GenerateChunk();
+	void GenerateChunk(const TerrainGenerator& generator, TerrainColumnCache& columnCache, std::vector<DecorationWrite>& out_outsideWrites, GenerationProfile* profile);
 	void PopulateFromFile(const std::vector<unsigned char>& fileBuffer);
-	void PopulateFromNoise();
+	void PopulateFromNoise(const TerrainGenerator& generator, TerrainColumnCache& columnCache, std::vector<DecorationWrite>& out_outsideWrites, GenerationProfile* profile);
+	void ApplyGeneratedDecorationWrites(const std::vector<DecorationWrite>& writes);
+	static void BuildTypeBlocks(Block* out_typeBlocks);
 
 	void InitializeLighting();
+	void CalculateSkyHeights();
 
 	bool SaveToFile();
 	void CompressToRLE(std::vector<unsigned char>& out_chunkBuffer);
+	static void CompressBlockTypesToRLE(const BlockType* blockTypes, std::vector<unsigned char>& out_chunkBuffer);
+	static std::string GetSaveFilePath(const IntVector2& chunkCoords);
+	static bool IsSaveFileCurrent(const std::vector<unsigned char>& fileBuffer);
 
 	int GetBlockIndexForBlockCoords(IntVector3 blockCoords);
 	IntVector3 GetBlockCoordsForBlockIndex(int blockIndex);
@@ -68,10 +119,24 @@ public:
 	const Vector3& GetChunkWorldMins() const;
 
 	const Vector3& GetChunkCenter() const;
+	unsigned int GetNumVertexes() const;
+	unsigned int GetNumVertexBytes() const;
+	unsigned int GetVBOID() const;
 	Block* GetBlockFromBlockCoords(const IntVector3& blockCoords);
 	Block* GetBlockFromBlockIndex(int blockIndex);
 	void MakeDirty();
 
+	int GetSkyHeight(int columnIndex) const;
+	void SetSkyHeight(int columnIndex, int skyHeight);
+	bool IsSkyBlock(int blockIndex) const;
+
+	int GetLodLevel() const;
+	void SetLodLevel(int lodLevel);
+	int GetLightingSlot() const;
+	void SetLightingSlot(int lightingSlot);
+
+	bool CanSeeThroughSection(int sectionIndex, SectionFace entryFace, SectionFace exitFace) const;
+
 	void SetNorthNeighbor(Chunk* northNeighbor);
 	void SetSouthNeighbor(Chunk* southNeighbor);
 	void SetEastNeighbor(Chunk* eastNeighbor);
@@ -134,6 +199,52 @@ inline void Chunk::MakeDirty()
 	m_isVBODirty = true;
 }
 
+inline int Chunk::GetSkyHeight(int columnIndex) const
+{
+	return m_skyHeights[columnIndex];
+}
+
+inline void Chunk::SetSkyHeight(int columnIndex, int skyHeight)
+{
+	m_skyHeights[columnIndex] = (unsigned char)skyHeight;
+}
+
+inline bool Chunk::IsSkyBlock(int blockIndex) const
+{
+	return (blockIndex >> CHUNK_XY_BITS) >= m_skyHeights[blockIndex & (BLOCKS_PER_LAYER - 1)];
+}
+
+inline int Chunk::GetLodLevel() const
+{
+	return m_lodLevel;
+}
+
+inline void Chunk::SetLodLevel(int lodLevel)
+{
+	if (lodLevel == m_lodLevel)
+		return;
+
+	m_lodLevel = lodLevel;
+	MakeDirty();
+}
+
+inline int Chunk::GetLightingSlot() const
+{
+	return m_lightingSlot;
+}
+
+inline void Chunk::SetLightingSlot(int lightingSlot)
+{
+	m_lightingSlot = lightingSlot;
+}
+
+inline bool Chunk::CanSeeThroughSection(int sectionIndex, SectionFace entryFace, SectionFace exitFace) const
+{
+	if (entryFace == SECTION_FACE_NONE)
+		return true;
+	return (m_sectionConnectivity[sectionIndex][entryFace] & BIT(exitFace)) != 0;
+}
+
 
 inline const IntVector2& Chunk::GetChunkCoords() const
 {
@@ -145,6 +256,21 @@ inline const Vector3& Chunk::GetChunkCenter() const
 	return m_chunkCenter;
 }
 
+inline unsigned int Chunk::GetNumVertexes() const
+{
+	return m_vertexes.size();
+}
+
+inline unsigned int Chunk::GetNumVertexBytes() const
+{
+	return m_vertexes.size() * sizeof(Vertex3D);
+}
+
+inline unsigned int Chunk::GetVBOID() const
+{
+	return m_vboID;
+}
+
 inline void Chunk::SetNorthNeighbor(Chunk* northNeighbor)
 {
 	m_northNeighbor = northNeighbor;
@@ -0,0 +1,216 @@
+#include "Game/ChunkLightingJob.hpp"
+
+
+ChunkLightingJob::ChunkLightingJob()
+	: m_chunk(nullptr)
+	, m_entries()
+	, m_outgoingLight()
+	, m_isScheduled(false)
+	, m_numVisits(0)
+	, m_numLightChanges(0)
+	, m_hasLitEastEdge(false)
+	, m_hasLitWestEdge(false)
+	, m_hasLitNorthEdge(false)
+	, m_hasLitSouthEdge(false)
+{
+
+}
+
+void ChunkLightingJob::Reset(Chunk* chunk)
+{
+	m_chunk = chunk;
+	m_entries.clear();
+	m_outgoingLight.clear();
+	m_isScheduled = false;
+	m_numVisits = 0;
+	m_numLightChanges = 0;
+	m_hasLitEastEdge = false;
+	m_hasLitWestEdge = false;
+	m_hasLitNorthEdge = false;
+	m_hasLitSouthEdge = false;
+}
+
+void ChunkLightingJob::Run()
+{
+	//Same flood as World::PropagateLightAddition, except light leaving the chunk is collected instead of applied
+	for (size_t readIndex = 0; readIndex < m_entries.size(); ++readIndex)
+	{
+		++m_numVisits;
+		LightChannel channel = GetLightJobEntryChannel(m_entries[readIndex]);
+		BlockInfo blockInfo(m_chunk, GetLightJobEntryBlockIndex(m_entries[readIndex]));
+		unsigned int lightValue = blockInfo.GetBlock()->GetLightValue(channel);
+		if (lightValue <= 1)
+			continue;
+
+		SpreadLightToBlock(blockInfo.GetBelowBlock(), channel, lightValue - 1);
+		SpreadLightToBlock(blockInfo.GetAboveBlock(), channel, lightValue - 1);
+		SpreadLightToBlock(blockInfo.GetNorthBlock(), channel, lightValue - 1);
+		SpreadLightToBlock(blockInfo.GetSouthBlock(), channel, lightValue - 1);
+		SpreadLightToBlock(blockInfo.GetEastBlock(), channel, lightValue - 1);
+		SpreadLightToBlock(blockInfo.GetWestBlock(), channel, lightValue - 1);
+	}
+
+	m_entries.clear();
+}
+
+void ChunkLightingJob::MarkLitEdgeNeighborsDirty()
+{
+	if (m_hasLitEastEdge && m_chunk->GetEastNeighbor())
+		m_chunk->GetEastNeighbor()->MakeDirty();
+	if (m_hasLitWestEdge && m_chunk->GetWestNeighbor())
+		m_chunk->GetWestNeighbor()->MakeDirty();
+	if (m_hasLitNorthEdge && m_chunk->GetNorthNeighbor())
+		m_chunk->GetNorthNeighbor()->MakeDirty();
+	if (m_hasLitSouthEdge && m_chunk->GetSouthNeighbor())
+		m_chunk->GetSouthNeighbor()->MakeDirty();
+
+	m_hasLitEastEdge = false;
+	m_hasLitWestEdge = false;
+	m_hasLitNorthEdge = false;
+	m_hasLitSouthEdge = false;
+}
+
+void ChunkLightingJob::SpreadLightToBlock(const BlockInfo& neighbor, LightChannel channel, unsigned int lightValue)
+{
+	if (!neighbor.m_chunk)
+		return;
+
+	if (neighbor.m_chunk != m_chunk)
+	{
+		m_outgoingLight.push_back(BorderLight(neighbor.m_chunk, neighbor.m_blockIndex, channel, lightValue));
+		return;
+	}
+
+	Block* neighborBlock = neighbor.GetBlock();
+	if (neighborBlock->GetIsOpaque() || neighborBlock->GetLightValue(channel) >= lightValue)
+		return;
+
+	neighborBlock->SetLightValue(channel, lightValue);
+	m_chunk->MakeDirty();
+	++m_numLightChanges;
+
+	//Neighboring chunk meshes are marked once the round is over, since another worker may own them now
+	int blockIndex = neighbor.m_blockIndex;
+	if ((blockIndex & X_MASK_BITS) == X_MASK_BITS)
+		m_hasLitEastEdge = true;
+	else if ((blockIndex & X_MASK_BITS) == 0)
+		m_hasLitWestEdge = true;
+
+	if ((blockIndex & Y_MASK_BITS) == Y_MASK_BITS)
+		m_hasLitNorthEdge = true;
+	else if ((blockIndex & Y_MASK_BITS) == 0)
+		m_hasLitSouthEdge = true;
+
+	AddBlock(blockIndex, channel);
+}
+
+
+ChunkLightingWorkerPool::ChunkLightingWorkerPool()
+	: m_workerThreads()
+	, m_mutex()
+	, m_roundStartCondition()
+	, m_roundEndCondition()
+	, m_roundNumber(0)
+	, m_numWorkersInRound(0)
+	, m_isShuttingDown(false)
+	, m_roundJobs(nullptr)
+	, m_maxRoundVisits(0)
+	, m_nextJobIndex(0)
+	, m_numRoundVisits(0)
+{
+	int numWorkers = (int)std::thread::hardware_concurrency() - 1;
+	for (int threadIndex = 0; threadIndex < numWorkers; ++threadIndex)
+	{
+		m_workerThreads.push_back(std::thread(&ChunkLightingWorkerPool::RunWorker, this));
+	}
+}
+
+ChunkLightingWorkerPool::~ChunkLightingWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> poolLock(m_mutex);
+		m_isShuttingDown = true;
+	}
+	m_roundStartCondition.notify_all();
+
+	for (size_t threadIndex = 0; threadIndex < m_workerThreads.size(); ++threadIndex)
+	{
+		m_workerThreads[threadIndex].join();
+	}
+}
+
+int ChunkLightingWorkerPool::RunJobs(std::vector<ChunkLightingJob*>& jobs, int maxVisits)
+{
+	m_roundJobs = &jobs;
+	m_maxRoundVisits = maxVisits;
+	m_nextJobIndex = 0;
+	m_numRoundVisits = 0;
+
+	//A single job is not worth waking the workers for
+	if (jobs.size() <= 1 || m_workerThreads.empty())
+	{
+		TakeJobs();
+	}
+	else
+	{
+		{
+			std::lock_guard<std::mutex> poolLock(m_mutex);
+			m_numWorkersInRound = (int)m_workerThreads.size();
+			++m_roundNumber;
+		}
+		m_roundStartCondition.notify_all();
+
+		TakeJobs();
+
+		std::unique_lock<std::mutex> poolLock(m_mutex);
+		m_roundEndCondition.wait(poolLock, [this]() { return m_numWorkersInRound == 0; });
+	}
+
+	//Jobs are taken in order, so everything before the last index handed out has run
+	int numJobsRun = m_nextJobIndex;
+	if (numJobsRun > (int)jobs.size())
+		numJobsRun = (int)jobs.size();
+	m_roundJobs = nullptr;
+	return numJobsRun;
+}
+
+void ChunkLightingWorkerPool::RunWorker()
+{
+	int lastRoundNumber = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> poolLock(m_mutex);
+			m_roundStartCondition.wait(poolLock, [this, lastRoundNumber]() { return m_isShuttingDown || m_roundNumber != lastRoundNumber; });
+			if (m_isShuttingDown)
+				return;
+			lastRoundNumber = m_roundNumber;
+		}
+
+		TakeJobs();
+
+		{
+			std::lock_guard<std::mutex> poolLock(m_mutex);
+			--m_numWorkersInRound;
+		}
+		m_roundEndCondition.notify_one();
+	}
+}
+
+void ChunkLightingWorkerPool::TakeJobs()
+{
+	//The budget is checked before each job; a job that has started floods its whole chunk
+	for (;;)
+	{
+		if (m_numRoundVisits >= m_maxRoundVisits)
+			return;
+
+		int jobIndex = m_nextJobIndex++;
+		if (jobIndex >= (int)m_roundJobs->size())
+			return;
+
+		ChunkLightingJob* job = (*m_roundJobs)[jobIndex];
+		job->Run();
+		m_numRoundVisits += job->m_numVisits;
+	}
+}
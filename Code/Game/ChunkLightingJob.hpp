@@ -0,0 +1,112 @@
+#pragma once
+#include "Game/BlockInfo.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+constexpr int LIGHT_JOB_ENTRY_CHANNEL_SHIFT = CHUNK_XY_BITS + CHUNK_Z_BITS;		//job entries are a block index with the light channel above it
+
+
+//Light that reached the edge of a chunk and continues into the neighboring chunk
+struct BorderLight
+{
+	Chunk* m_targetChunk;
+	int m_blockIndex;
+	LightChannel m_channel;
+	unsigned int m_lightValue;
+
+	BorderLight(Chunk* targetChunk, int blockIndex, LightChannel channel, unsigned int lightValue);
+};
+
+
+//Light additions confined to a single chunk, so jobs for different chunks can run at the same time
+class ChunkLightingJob
+{
+public:
+	Chunk* m_chunk;
+	std::vector<unsigned int> m_entries;
+	std::vector<BorderLight> m_outgoingLight;		//handed to the neighboring chunks between rounds
+	bool m_isScheduled;
+
+	int m_numVisits;
+	int m_numLightChanges;
+	bool m_hasLitEastEdge;
+	bool m_hasLitWestEdge;
+	bool m_hasLitNorthEdge;
+	bool m_hasLitSouthEdge;
+
+	ChunkLightingJob();
+
+	void Reset(Chunk* chunk);
+	void AddBlock(int blockIndex, LightChannel channel);
+	void Run();
+	void MarkLitEdgeNeighborsDirty();
+
+private:
+	void SpreadLightToBlock(const BlockInfo& neighbor, LightChannel channel, unsigned int lightValue);
+};
+
+
+//Worker threads started once and woken for each lighting round, the calling thread takes jobs as well
+class ChunkLightingWorkerPool
+{
+public:
+	ChunkLightingWorkerPool();
+	~ChunkLightingWorkerPool();
+
+	int RunJobs(std::vector<ChunkLightingJob*>& jobs, int maxVisits);
+	int GetNumThreads() const;
+
+private:
+	std::vector<std::thread> m_workerThreads;
+	std::mutex m_mutex;
+	std::condition_variable m_roundStartCondition;
+	std::condition_variable m_roundEndCondition;
+	int m_roundNumber;
+	int m_numWorkersInRound;
+	bool m_isShuttingDown;
+
+	std::vector<ChunkLightingJob*>* m_roundJobs;
+	int m_maxRoundVisits;
+	std::atomic<int> m_nextJobIndex;
+	std::atomic<int> m_numRoundVisits;
+
+	ChunkLightingWorkerPool(const ChunkLightingWorkerPool&) = delete;
+	void operator=(const ChunkLightingWorkerPool&) = delete;
+
+	void RunWorker();
+	void TakeJobs();
+};
+
+
+inline BorderLight::BorderLight(Chunk* targetChunk, int blockIndex, LightChannel channel, unsigned int lightValue)
+	: m_targetChunk(targetChunk)
+	, m_blockIndex(blockIndex)
+	, m_channel(channel)
+	, m_lightValue(lightValue)
+{
+
+}
+
+inline int ChunkLightingWorkerPool::GetNumThreads() const
+{
+	return (int)m_workerThreads.size() + 1;
+}
+
+inline void ChunkLightingJob::AddBlock(int blockIndex, LightChannel channel)
+{
+	m_entries.push_back((unsigned int)blockIndex | ((unsigned int)channel << LIGHT_JOB_ENTRY_CHANNEL_SHIFT));
+}
+
+inline int GetLightJobEntryBlockIndex(unsigned int entry)
+{
+	return (int)(entry & (BLOCKS_PER_CHUNK - 1));
+}
+
+inline LightChannel GetLightJobEntryChannel(unsigned int entry)
+{
+	return (LightChannel)(entry >> LIGHT_JOB_ENTRY_CHANNEL_SHIFT);
+}
@@ -0,0 +1,247 @@
+#include "Game/ChunkQuadTree.hpp"
+
+
+ChunkQuadTreeNode::ChunkQuadTreeNode(const IntVector2& chunkMins, int chunkSpan)
+	: m_chunkMins(chunkMins)
+	, m_chunkSpan(chunkSpan)
+	, m_numChunks(0)
+	, m_boundsMins()
+	, m_boundsMaxs()
+	, m_chunk(nullptr)
+{
+	for (int childIndex = 0; childIndex < 4; ++childIndex)
+	{
+		m_children[childIndex] = nullptr;
+	}
+}
+
+ChunkQuadTreeNode::~ChunkQuadTreeNode()
+{
+	for (int childIndex = 0; childIndex < 4; ++childIndex)
+	{
+		delete m_children[childIndex];
+		m_children[childIndex] = nullptr;
+	}
+}
+
+void ChunkQuadTreeNode::RecalculateBounds()
+{
+	if (IsLeaf())
+	{
+		if (m_chunk)
+		{
+			m_boundsMins = Vector2(m_chunk->GetChunkWorldMins().x, m_chunk->GetChunkWorldMins().y);
+			m_boundsMaxs = m_boundsMins + Vector2((float)CHUNK_X, (float)CHUNK_Y);
+		}
+		return;
+	}
+
+	bool isFirstChild = true;
+	for (int childIndex = 0; childIndex < 4; ++childIndex)
+	{
+		ChunkQuadTreeNode* child = m_children[childIndex];
+		if (!child)
+			continue;
+
+		if (isFirstChild)
+		{
+			m_boundsMins = child->m_boundsMins;
+			m_boundsMaxs = child->m_boundsMaxs;
+			isFirstChild = false;
+			continue;
+		}
+
+		if (child->m_boundsMins.x < m_boundsMins.x)
+			m_boundsMins.x = child->m_boundsMins.x;
+		if (child->m_boundsMins.y < m_boundsMins.y)
+			m_boundsMins.y = child->m_boundsMins.y;
+		if (child->m_boundsMaxs.x > m_boundsMaxs.x)
+			m_boundsMaxs.x = child->m_boundsMaxs.x;
+		if (child->m_boundsMaxs.y > m_boundsMaxs.y)
+			m_boundsMaxs.y = child->m_boundsMaxs.y;
+	}
+}
+
+
+ChunkQuadTree::ChunkQuadTree()
+	: m_rootNodes()
+	, m_numNodesTestedLastQuery(0)
+{
+
+}
+
+ChunkQuadTree::~ChunkQuadTree()
+{
+	for (std::map<IntVector2, ChunkQuadTreeNode*>::iterator rootIter = m_rootNodes.begin(); rootIter != m_rootNodes.end(); ++rootIter)
+	{
+		delete rootIter->second;
+	}
+	m_rootNodes.clear();
+}
+
+void ChunkQuadTree::AddChunk(Chunk* chunk)
+{
+	const IntVector2& chunkCoords = chunk->GetChunkCoords();
+	IntVector2 regionCoords(chunkCoords.x >> QUADTREE_REGION_BITS, chunkCoords.y >> QUADTREE_REGION_BITS);
+
+	ChunkQuadTreeNode* rootNode = nullptr;
+	std::map<IntVector2, ChunkQuadTreeNode*>::iterator found = m_rootNodes.find(regionCoords);
+	if (found != m_rootNodes.end())
+	{
+		rootNode = found->second;
+	}
+	else
+	{
+		rootNode = new ChunkQuadTreeNode(IntVector2(regionCoords.x << QUADTREE_REGION_BITS, regionCoords.y << QUADTREE_REGION_BITS), QUADTREE_REGION_SIZE);
+		m_rootNodes[regionCoords] = rootNode;
+	}
+
+	AddChunkToNode(rootNode, chunk);
+}
+
+void ChunkQuadTree::RemoveChunk(Chunk* chunk)
+{
+	const IntVector2& chunkCoords = chunk->GetChunkCoords();
+	IntVector2 regionCoords(chunkCoords.x >> QUADTREE_REGION_BITS, chunkCoords.y >> QUADTREE_REGION_BITS);
+
+	std::map<IntVector2, ChunkQuadTreeNode*>::iterator found = m_rootNodes.find(regionCoords);
+	if (found == m_rootNodes.end())
+		return;
+
+	ChunkQuadTreeNode* rootNode = found->second;
+	if (RemoveChunkFromNode(rootNode, chunk) && rootNode->m_numChunks == 0)
+	{
+		delete rootNode;
+		m_rootNodes.erase(found);
+	}
+}
+
+void ChunkQuadTree::CollectVisibleChunks(const Vector3& cameraPosition, const Vector3& cameraForward, float visibilityRange, std::vector<Chunk*>& out_visibleChunks) const
+{
+	m_numNodesTestedLastQuery = 0;
+	float visibilityRangeSquared = visibilityRange * visibilityRange;
+
+	for (std::map<IntVector2, ChunkQuadTreeNode*>::const_iterator rootIter = m_rootNodes.begin(); rootIter != m_rootNodes.end(); ++rootIter)
+	{
+		CollectVisibleChunksInNode(rootIter->second, cameraPosition, cameraForward, visibilityRangeSquared, out_visibleChunks);
+	}
+}
+
+void ChunkQuadTree::AddChunkToNode(ChunkQuadTreeNode* node, Chunk* chunk)
+{
+	if (node->IsLeaf())
+	{
+		node->m_chunk = chunk;
+		node->m_numChunks = 1;
+		node->RecalculateBounds();
+		return;
+	}
+
+	int childIndex = node->GetChildIndexForChunkCoords(chunk->GetChunkCoords());
+	ChunkQuadTreeNode* child = node->m_children[childIndex];
+	if (!child)
+	{
+		child = new ChunkQuadTreeNode(node->GetChildChunkMins(childIndex), node->m_chunkSpan >> 1);
+		node->m_children[childIndex] = child;
+	}
+
+	int numChunksBefore = child->m_numChunks;
+	AddChunkToNode(child, chunk);
+	node->m_numChunks += child->m_numChunks - numChunksBefore;
+	node->RecalculateBounds();
+}
+
+bool ChunkQuadTree::RemoveChunkFromNode(ChunkQuadTreeNode* node, Chunk* chunk)
+{
+	if (node->IsLeaf())
+	{
+		if (node->m_chunk != chunk)
+			return false;
+
+		node->m_chunk = nullptr;
+		node->m_numChunks = 0;
+		return true;
+	}
+
+	int childIndex = node->GetChildIndexForChunkCoords(chunk->GetChunkCoords());
+	ChunkQuadTreeNode* child = node->m_children[childIndex];
+	if (!child || !RemoveChunkFromNode(child, chunk))
+		return false;
+
+	if (child->m_numChunks == 0)
+	{
+		delete child;
+		node->m_children[childIndex] = nullptr;
+	}
+
+	--node->m_numChunks;
+	node->RecalculateBounds();
+	return true;
+}
+
+void ChunkQuadTree::CollectVisibleChunksInNode(const ChunkQuadTreeNode* node, const Vector3& cameraPosition, const Vector3& cameraForward, float visibilityRangeSquared, std::vector<Chunk*>& out_visibleChunks) const
+{
+	++m_numNodesTestedLastQuery;
+
+	//Distance from the camera to the nearest and furthest points of the node bounds in XY
+	float nearestX = ClampFloat(cameraPosition.x, node->m_boundsMins.x, node->m_boundsMaxs.x);
+	float nearestY = ClampFloat(cameraPosition.y, node->m_boundsMins.y, node->m_boundsMaxs.y);
+	float nearestDistanceSquared = ((nearestX - cameraPosition.x) * (nearestX - cameraPosition.x)) + ((nearestY - cameraPosition.y) * (nearestY - cameraPosition.y));
+	if (nearestDistanceSquared > visibilityRangeSquared)
+	{
+		return;
+	}
+
+	float furthestX = (cameraPosition.x - node->m_boundsMins.x > node->m_boundsMaxs.x - cameraPosition.x) ? node->m_boundsMins.x : node->m_boundsMaxs.x;
+	float furthestY = (cameraPosition.y - node->m_boundsMins.y > node->m_boundsMaxs.y - cameraPosition.y) ? node->m_boundsMins.y : node->m_boundsMaxs.y;
+	float furthestDistanceSquared = ((furthestX - cameraPosition.x) * (furthestX - cameraPosition.x)) + ((furthestY - cameraPosition.y) * (furthestY - cameraPosition.y));
+
+	//Corners of the bounds furthest along and furthest against the camera's forward direction
+	Vector3 boundsMins(node->m_boundsMins.x, node->m_boundsMins.y, 0.f);
+	Vector3 boundsMaxs(node->m_boundsMaxs.x, node->m_boundsMaxs.y, (float)CHUNK_Z);
+
+	Vector3 mostForwardCorner(cameraForward.x > 0.f ? boundsMaxs.x : boundsMins.x, cameraForward.y > 0.f ? boundsMaxs.y : boundsMins.y, cameraForward.z > 0.f ? boundsMaxs.z : boundsMins.z);
+	if (DotProduct(cameraForward, mostForwardCorner - cameraPosition) <= 0.f)
+	{
+		return;
+	}
+
+	Vector3 mostBackwardCorner(cameraForward.x > 0.f ? boundsMins.x : boundsMaxs.x, cameraForward.y > 0.f ? boundsMins.y : boundsMaxs.y, cameraForward.z > 0.f ? boundsMins.z : boundsMaxs.z);
+	if (DotProduct(cameraForward, mostBackwardCorner - cameraPosition) > 0.f && furthestDistanceSquared <= visibilityRangeSquared)
+	{
+		//Entire node is in front of the camera and in range, so skip testing its children
+		CollectAllChunksInNode(node, out_visibleChunks);
+		return;
+	}
+
+	if (node->IsLeaf())
+	{
+		out_visibleChunks.push_back(node->m_chunk);
+		return;
+	}
+
+	for (int childIndex = 0; childIndex < 4; ++childIndex)
+	{
+		if (node->m_children[childIndex])
+		{
+			CollectVisibleChunksInNode(node->m_children[childIndex], cameraPosition, cameraForward, visibilityRangeSquared, out_visibleChunks);
+		}
+	}
+}
+
+void ChunkQuadTree::CollectAllChunksInNode(const ChunkQuadTreeNode* node, std::vector<Chunk*>& out_chunks) const
+{
+	if (node->IsLeaf())
+	{
+		out_chunks.push_back(node->m_chunk);
+		return;
+	}
+
+	for (int childIndex = 0; childIndex < 4; ++childIndex)
+	{
+		if (node->m_children[childIndex])
+		{
+			CollectAllChunksInNode(node->m_children[childIndex], out_chunks);
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "Game/Chunk.hpp"
+#include "Engine/Math/Vector2.hpp"
+#include <map>
+#include <vector>
+
+
+constexpr int QUADTREE_REGION_BITS = 4;
+constexpr int QUADTREE_REGION_SIZE = BIT(QUADTREE_REGION_BITS);		//each root node covers 16x16 chunks
+
+
+struct ChunkQuadTreeNode
+{
+	IntVector2 m_chunkMins;
+	int m_chunkSpan;
+	int m_numChunks;
+
+	Vector2 m_boundsMins;		//tight XY bounds of the loaded chunks below this node, in world units
+	Vector2 m_boundsMaxs;
+
+	Chunk* m_chunk;
+	ChunkQuadTreeNode* m_children[4];
+
+	ChunkQuadTreeNode(const IntVector2& chunkMins, int chunkSpan);
+	~ChunkQuadTreeNode();
+
+	bool IsLeaf() const;
+	int GetChildIndexForChunkCoords(const IntVector2& chunkCoords) const;
+	IntVector2 GetChildChunkMins(int childIndex) const;
+	void RecalculateBounds();
+};
+
+
+class ChunkQuadTree
+{
+public:
+	ChunkQuadTree();
+	~ChunkQuadTree();
+
+	void AddChunk(Chunk* chunk);
+	void RemoveChunk(Chunk* chunk);
+
+	void CollectVisibleChunks(const Vector3& cameraPosition, const Vector3& cameraForward, float visibilityRange, std::vector<Chunk*>& out_visibleChunks) const;
+
+	int GetNumNodesTestedLastQuery() const;
+
+private:
+	std::map<IntVector2, ChunkQuadTreeNode*> m_rootNodes;
+	mutable int m_numNodesTestedLastQuery;
+
+	void AddChunkToNode(ChunkQuadTreeNode* node, Chunk* chunk);
+	bool RemoveChunkFromNode(ChunkQuadTreeNode* node, Chunk* chunk);
+	void CollectVisibleChunksInNode(const ChunkQuadTreeNode* node, const Vector3& cameraPosition, const Vector3& cameraForward, float visibilityRangeSquared, std::vector<Chunk*>& out_visibleChunks) const;
+	void CollectAllChunksInNode(const ChunkQuadTreeNode* node, std::vector<Chunk*>& out_chunks) const;
+};
+
+
+inline bool ChunkQuadTreeNode::IsLeaf() const
+{
+	return m_chunkSpan == 1;
+}
+
+inline int ChunkQuadTreeNode::GetChildIndexForChunkCoords(const IntVector2& chunkCoords) const
+{
+	int halfSpan = m_chunkSpan >> 1;
+	int childIndex = 0;
+	if (chunkCoords.x - m_chunkMins.x >= halfSpan)
+		childIndex += 1;
+	if (chunkCoords.y - m_chunkMins.y >= halfSpan)
+		childIndex += 2;
+	return childIndex;
+}
+
+inline IntVector2 ChunkQuadTreeNode::GetChildChunkMins(int childIndex) const
+{
+	int halfSpan = m_chunkSpan >> 1;
+	return IntVector2(m_chunkMins.x + ((childIndex & 1) * halfSpan), m_chunkMins.y + (((childIndex >> 1) & 1) * halfSpan));
+}
+
+inline int ChunkQuadTree::GetNumNodesTestedLastQuery() const
+{
+	return m_numNodesTestedLastQuery;
+}
@@ -0,0 +1,113 @@
+#include "Game/DecorationWriteStore.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include <stdio.h>
+
+
+DecorationWriteStore::DecorationWriteStore()
+	: m_mutex()
+	, m_writesByChunk()
+	, m_numPendingWrites(0)
+{
+
+}
+
+void DecorationWriteStore::AddWrites(const std::vector<DecorationWrite>& writes)
+{
+	std::lock_guard<std::mutex> storeLock(m_mutex);
+	for (size_t writeIndex = 0; writeIndex < writes.size(); ++writeIndex)
+	{
+		m_writesByChunk[writes[writeIndex].m_chunkCoords].push_back(writes[writeIndex]);
+	}
+	m_numPendingWrites += (int)writes.size();
+}
+
+void DecorationWriteStore::TakeWrites(const IntVector2& chunkCoords, std::vector<DecorationWrite>& out_writes)
+{
+	{
+		std::lock_guard<std::mutex> storeLock(m_mutex);
+		std::map<IntVector2, std::vector<DecorationWrite>>::iterator found = m_writesByChunk.find(chunkCoords);
+		if (found != m_writesByChunk.end())
+		{
+			out_writes.insert(out_writes.end(), found->second.begin(), found->second.end());
+			m_numPendingWrites -= (int)found->second.size();
+			m_writesByChunk.erase(found);
+		}
+	}
+
+	//Writes left over from an earlier session, each is two bytes of block index and one of block type after the version
+	//Read without the lock, only whoever is generating the chunk touches its file and SaveToFiles never runs alongside workers
+	std::vector<unsigned char> fileBuffer;
+	std::string filePath = GetSaveFilePath(chunkCoords);
+	if (!ReadBufferFromFile(fileBuffer, filePath))
+		return;
+
+	if (!fileBuffer.empty() && fileBuffer[0] == g_GAME_VERSION)
+	{
+		for (size_t bufferIndex = 1; bufferIndex + 2 < fileBuffer.size(); bufferIndex += 3)
+		{
+			int blockIndex = (int)fileBuffer[bufferIndex] | ((int)fileBuffer[bufferIndex + 1] << 8);
+			out_writes.push_back(DecorationWrite(chunkCoords, blockIndex, (BlockType)fileBuffer[bufferIndex + 2]));
+		}
+	}
+	remove(filePath.c_str());
+}
+
+void DecorationWriteStore::SaveToFiles()
+{
+	//Writing files happens after the lock is released, so workers taking writes don't wait on the disk
+	std::map<IntVector2, std::vector<DecorationWrite>> writesByChunk;
+	{
+		std::lock_guard<std::mutex> storeLock(m_mutex);
+		writesByChunk.swap(m_writesByChunk);
+		m_numPendingWrites = 0;
+	}
+
+	for (std::map<IntVector2, std::vector<DecorationWrite>>::iterator chunkIter = writesByChunk.begin(); chunkIter != writesByChunk.end(); ++chunkIter)
+	{
+		//Appends to writes an earlier session already left for the chunk
+		std::vector<unsigned char> fileBuffer;
+		std::string filePath = GetSaveFilePath(chunkIter->first);
+		if (!ReadBufferFromFile(fileBuffer, filePath) || fileBuffer.empty() || fileBuffer[0] != g_GAME_VERSION)
+		{
+			fileBuffer.clear();
+			fileBuffer.push_back((unsigned char)g_GAME_VERSION);
+		}
+
+		const std::vector<DecorationWrite>& writes = chunkIter->second;
+		fileBuffer.reserve(fileBuffer.size() + (writes.size() * 3));
+		for (size_t writeIndex = 0; writeIndex < writes.size(); ++writeIndex)
+		{
+			fileBuffer.push_back((unsigned char)(writes[writeIndex].m_blockIndex & 0xff));
+			fileBuffer.push_back((unsigned char)(writes[writeIndex].m_blockIndex >> 8));
+			fileBuffer.push_back((unsigned char)writes[writeIndex].m_blockType);
+		}
+		WriteBufferToFile(fileBuffer, filePath);
+	}
+}
+
+int DecorationWriteStore::GetNumPendingChunks() const
+{
+	std::lock_guard<std::mutex> storeLock(m_mutex);
+	return (int)m_writesByChunk.size();
+}
+
+int DecorationWriteStore::GetNumPendingWrites() const
+{
+	std::lock_guard<std::mutex> storeLock(m_mutex);
+	return m_numPendingWrites;
+}
+
+void DecorationWriteStore::ApplyWrites(const std::vector<DecorationWrite>& writes, BlockType* blockTypes)
+{
+	for (size_t writeIndex = 0; writeIndex < writes.size(); ++writeIndex)
+	{
+		BlockType& blockType = blockTypes[writes[writeIndex].m_blockIndex];
+		if (CanDecorationReplace(blockType, writes[writeIndex].m_blockType))
+			blockType = writes[writeIndex].m_blockType;
+	}
+}
+
+std::string DecorationWriteStore::GetSaveFilePath(const IntVector2& chunkCoords)
+{
+	return "Data/Save/Decoration_(" + std::to_string(chunkCoords.x) + "," + std::to_string(chunkCoords.y) + ").dec";
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Game/BlockDefinition.hpp"
+#include "Engine/Math/IntVector2.hpp"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+//A block a decoration places in a chunk other than the one that generated it
+struct DecorationWrite
+{
+	IntVector2 m_chunkCoords;
+	int m_blockIndex;
+	BlockType m_blockType;
+
+	DecorationWrite(const IntVector2& chunkCoords, int blockIndex, BlockType blockType);
+};
+
+
+//Where decorations overlap the highest priority block is kept, so writes can be applied in any order
+//Blocks without a priority are terrain and are never replaced
+inline int GetDecorationPriority(BlockType blockType)
+{
+	switch (blockType)
+	{
+	case BLOCK_TYPE_AIR:
+		return 0;
+	case BLOCK_TYPE_LEAVES:
+		return 1;
+	case BLOCK_TYPE_WOOD_LOG:
+		return 2;
+	case BLOCK_TYPE_GLOWSTONE:
+		return 3;
+	default:
+		return -1;
+	}
+}
+
+inline bool CanDecorationReplace(BlockType existingType, BlockType decorationType)
+{
+	int existingPriority = GetDecorationPriority(existingType);
+	return existingPriority >= 0 && GetDecorationPriority(decorationType) > existingPriority;
+}
+
+
+//Decoration writes waiting for their chunk to be generated or loaded, kept on disk across sessions
+class DecorationWriteStore
+{
+public:
+	DecorationWriteStore();
+
+	void AddWrites(const std::vector<DecorationWrite>& writes);
+	void TakeWrites(const IntVector2& chunkCoords, std::vector<DecorationWrite>& out_writes);
+	void SaveToFiles();
+
+	int GetNumPendingChunks() const;
+	int GetNumPendingWrites() const;
+
+	static void ApplyWrites(const std::vector<DecorationWrite>& writes, BlockType* blockTypes);
+	static std::string GetSaveFilePath(const IntVector2& chunkCoords);
+
+private:
+	mutable std::mutex m_mutex;		//pregeneration workers share one store, it guards the writes in memory but not the files
+	std::map<IntVector2, std::vector<DecorationWrite>> m_writesByChunk;
+	int m_numPendingWrites;
+};
+
+
+inline DecorationWrite::DecorationWrite(const IntVector2& chunkCoords, int blockIndex, BlockType blockType)
+	: m_chunkCoords(chunkCoords)
+	, m_blockIndex(blockIndex)
+	, m_blockType(blockType)
+{
+
+}
@@ -0,0 +1,296 @@
+#include "Game/FarTerrain.hpp"
+
+
+FarTerrainTile::FarTerrainTile(const IntVector2& tileCoords)
+	: m_tileCoords(tileCoords)
+	, m_tileMins((float)(tileCoords.x << FAR_TERRAIN_TILE_BITS), (float)(tileCoords.y << FAR_TERRAIN_TILE_BITS))
+	, m_tileMaxs()
+	, m_surfaceHeights()
+	, m_surfaceTypes()
+	, m_numVertexes(0)
+	, m_isMeshDirty(true)
+	, m_hasCutout(false)
+{
+	m_tileMaxs = m_tileMins + Vector2((float)FAR_TERRAIN_TILE_SIZE, (float)FAR_TERRAIN_TILE_SIZE);
+	g_theRenderer->CreateVBOs(1, &m_vboID);
+}
+
+FarTerrainTile::~FarTerrainTile()
+{
+	g_theRenderer->DeleteVBOs(1, &m_vboID);
+}
+
+
+FarTerrain::FarTerrain(const TerrainNoiseSettings& noiseSettings)
+	: m_noiseSettings(noiseSettings)
+	, m_tiles()
+	, m_cutoutChunkCoords(0, 0)
+	, m_skyLightLevel(SKY_LIGHT_VALUE)
+	, m_numTilesDrawn(0)
+{
+
+}
+
+FarTerrain::~FarTerrain()
+{
+	for (std::map<IntVector2, FarTerrainTile*>::iterator tileIter = m_tiles.begin(); tileIter != m_tiles.end(); ++tileIter)
+	{
+		delete tileIter->second;
+	}
+	m_tiles.clear();
+}
+
+void FarTerrain::Update(const Vector3& playerPosition)
+{
+	Vector2 playerPositionXY(playerPosition.x, playerPosition.y);
+
+	//Loaded chunks follow the player, so the hole left for them has to as well
+	IntVector2 playerChunkCoords((int)floor(playerPosition.x) >> CHUNK_X_BITS, (int)floor(playerPosition.y) >> CHUNK_Y_BITS);
+	if (playerChunkCoords != m_cutoutChunkCoords)
+	{
+		m_cutoutChunkCoords = playerChunkCoords;
+		for (std::map<IntVector2, FarTerrainTile*>::iterator tileIter = m_tiles.begin(); tileIter != m_tiles.end(); ++tileIter)
+		{
+			if (tileIter->second->m_hasCutout || DoesTileOverlapCutout(tileIter->second))
+				tileIter->second->m_isMeshDirty = true;
+		}
+	}
+
+	RemoveDistantTiles(playerPositionXY);
+	AddNearestMissingTiles(playerPositionXY);
+	RebuildDirtyTileMeshes();
+}
+
+void FarTerrain::Render(const Vector3& cameraPosition, const Vector3& cameraForward) const
+{
+	m_numTilesDrawn = 0;
+	for (std::map<IntVector2, FarTerrainTile*>::const_iterator tileIter = m_tiles.begin(); tileIter != m_tiles.end(); ++tileIter)
+	{
+		const FarTerrainTile* tile = tileIter->second;
+		if (tile->m_numVertexes == 0)
+			continue;
+
+		//Skip tiles entirely behind the camera
+		Vector3 mostForwardCorner(cameraForward.x > 0.f ? tile->m_tileMaxs.x : tile->m_tileMins.x, cameraForward.y > 0.f ? tile->m_tileMaxs.y : tile->m_tileMins.y, cameraForward.z > 0.f ? (float)CHUNK_Z : 0.f);
+		if (DotProduct(cameraForward, mostForwardCorner - cameraPosition) <= 0.f)
+			continue;
+
+		g_theRenderer->BindBuffer(tile->m_vboID);
+		g_theRenderer->DrawVBO(tile->m_numVertexes, PRIMITIVE_QUADS);
+		++m_numTilesDrawn;
+	}
+
+	if (m_numTilesDrawn > 0)
+	{
+		g_theRenderer->BindBuffer(0);
+	}
+}
+
+void FarTerrain::SetSkyLightLevel(unsigned int skyLightLevel)
+{
+	if (skyLightLevel == m_skyLightLevel)
+		return;
+
+	//Far terrain is all open to the sky, so the sky level alone sets its color
+	m_skyLightLevel = skyLightLevel;
+	for (std::map<IntVector2, FarTerrainTile*>::iterator tileIter = m_tiles.begin(); tileIter != m_tiles.end(); ++tileIter)
+	{
+		tileIter->second->m_isMeshDirty = true;
+	}
+}
+
+unsigned int FarTerrain::GetNumVertexes() const
+{
+	unsigned int numVertexes = 0;
+	for (std::map<IntVector2, FarTerrainTile*>::const_iterator tileIter = m_tiles.begin(); tileIter != m_tiles.end(); ++tileIter)
+	{
+		numVertexes += tileIter->second->m_numVertexes;
+	}
+	return numVertexes;
+}
+
+unsigned int FarTerrain::GetNumBytes() const
+{
+	unsigned int numSampleBytes = FAR_TERRAIN_SAMPLES_PER_SIDE * FAR_TERRAIN_SAMPLES_PER_SIDE * (sizeof(float) + sizeof(BlockType));
+	return (GetNumVertexes() * sizeof(Vertex3D)) + (m_tiles.size() * (sizeof(FarTerrainTile) + numSampleBytes));
+}
+
+void FarTerrain::RemoveDistantTiles(const Vector2& playerPositionXY)
+{
+	std::map<IntVector2, FarTerrainTile*>::iterator tileIter = m_tiles.begin();
+	while (tileIter != m_tiles.end())
+	{
+		FarTerrainTile* tile = tileIter->second;
+		if (IsTileInRange(tile->m_tileMins, tile->m_tileMaxs, playerPositionXY, (float)FAR_TERRAIN_TILE_SIZE))
+		{
+			++tileIter;
+			continue;
+		}
+
+		delete tile;
+		tileIter = m_tiles.erase(tileIter);
+	}
+}
+
+void FarTerrain::AddNearestMissingTiles(const Vector2& playerPositionXY)
+{
+	int playerTileX = (int)floor(playerPositionXY.x) >> FAR_TERRAIN_TILE_BITS;
+	int playerTileY = (int)floor(playerPositionXY.y) >> FAR_TERRAIN_TILE_BITS;
+	int tileHalfExtent = (int)ceil(FAR_TERRAIN_RANGE / (float)FAR_TERRAIN_TILE_SIZE);
+
+	for (int numTilesBuilt = 0; numTilesBuilt < FAR_TERRAIN_TILES_BUILT_PER_UPDATE; ++numTilesBuilt)
+	{
+		bool hasFoundMissingTile = false;
+		IntVector2 nearestMissingTileCoords(0, 0);
+		float distanceSquaredToNearestMissingTile = 0.f;
+
+		for (int tileY = playerTileY - tileHalfExtent; tileY <= playerTileY + tileHalfExtent; ++tileY)
+		{
+			for (int tileX = playerTileX - tileHalfExtent; tileX <= playerTileX + tileHalfExtent; ++tileX)
+			{
+				IntVector2 tileCoords(tileX, tileY);
+				Vector2 tileMins((float)(tileX << FAR_TERRAIN_TILE_BITS), (float)(tileY << FAR_TERRAIN_TILE_BITS));
+				Vector2 tileMaxs = tileMins + Vector2((float)FAR_TERRAIN_TILE_SIZE, (float)FAR_TERRAIN_TILE_SIZE);
+				if (!IsTileInRange(tileMins, tileMaxs, playerPositionXY, 0.f) || m_tiles.find(tileCoords) != m_tiles.end())
+					continue;
+
+				float distanceSquaredToTile = CalcDistanceSquared(playerPositionXY, (tileMins + tileMaxs) * 0.5f);
+				if (!hasFoundMissingTile || distanceSquaredToTile < distanceSquaredToNearestMissingTile)
+				{
+					hasFoundMissingTile = true;
+					nearestMissingTileCoords = tileCoords;
+					distanceSquaredToNearestMissingTile = distanceSquaredToTile;
+				}
+			}
+		}
+
+		if (!hasFoundMissingTile)
+			return;
+
+		FarTerrainTile* newTile = new FarTerrainTile(nearestMissingTileCoords);
+		SampleTile(newTile);
+		RebuildTileMesh(newTile);
+		m_tiles[nearestMissingTileCoords] = newTile;
+	}
+}
+
+void FarTerrain::RebuildDirtyTileMeshes()
+{
+	//Remeshing only re-reads the cached samples, so every dirty tile can be redone in the same update
+	for (std::map<IntVector2, FarTerrainTile*>::iterator tileIter = m_tiles.begin(); tileIter != m_tiles.end(); ++tileIter)
+	{
+		if (tileIter->second->m_isMeshDirty)
+		{
+			RebuildTileMesh(tileIter->second);
+		}
+	}
+}
+
+void FarTerrain::SampleTile(FarTerrainTile* tile) const
+{
+	tile->m_surfaceHeights.resize(FAR_TERRAIN_SAMPLES_PER_SIDE * FAR_TERRAIN_SAMPLES_PER_SIDE);
+	tile->m_surfaceTypes.resize(FAR_TERRAIN_SAMPLES_PER_SIDE * FAR_TERRAIN_SAMPLES_PER_SIDE);
+
+	for (int sampleY = 0; sampleY < FAR_TERRAIN_SAMPLES_PER_SIDE; ++sampleY)
+	{
+		for (int sampleX = 0; sampleX < FAR_TERRAIN_SAMPLES_PER_SIDE; ++sampleX)
+		{
+			float worldX = tile->m_tileMins.x + (float)(sampleX * FAR_TERRAIN_SAMPLE_SPACING);
+			float worldY = tile->m_tileMins.y + (float)(sampleY * FAR_TERRAIN_SAMPLE_SPACING);
+
+			//Same fields as Chunk::PopulateFromNoise, keeping only the top of each column
+			float mountainousness = ComputeLowFrequencyFieldValue(m_noiseSettings, TERRAIN_NOISE_MOUNTAINOUSNESS, worldX, worldY);
+			int columnHeight = ComputeColumnHeight(m_noiseSettings.m_worldSeed, worldX, worldY, mountainousness);
+			int surfaceZ = columnHeight + GRASS_OFFSET - 1;
+
+			int sampleIndex = sampleX + (sampleY * FAR_TERRAIN_SAMPLES_PER_SIDE);
+			if (surfaceZ < SEA_LEVEL)
+			{
+				tile->m_surfaceHeights[sampleIndex] = (float)(SEA_LEVEL + 1);
+				tile->m_surfaceTypes[sampleIndex] = BLOCK_TYPE_WATER;
+			}
+			else
+			{
+				tile->m_surfaceHeights[sampleIndex] = (float)(surfaceZ + 1);
+				tile->m_surfaceTypes[sampleIndex] = GetSurfaceBlockType(surfaceZ, ComputeWetness(m_noiseSettings.m_worldSeed, worldX, worldY), ComputeLowFrequencyFieldValue(m_noiseSettings, TERRAIN_NOISE_TEMPERATURE, worldX, worldY));
+			}
+		}
+	}
+}
+
+void FarTerrain::RebuildTileMesh(FarTerrainTile* tile) const
+{
+	std::vector<Vertex3D> vertexArray;
+	vertexArray.reserve(FAR_TERRAIN_CELLS_PER_SIDE * FAR_TERRAIN_CELLS_PER_SIDE * VERTEXES_PER_FACE);
+
+	Vector2 cutoutCenter = GetCutoutCenter();
+	float innerRangeSquared = FAR_TERRAIN_INNER_RANGE * FAR_TERRAIN_INNER_RANGE;
+	tile->m_hasCutout = false;
+	unsigned char lightRGBAValue = LIGHT_RGBA_VALUES[m_skyLightLevel];
+	Rgba lightColor(lightRGBAValue, lightRGBAValue, lightRGBAValue, 255);
+
+	const int cornerOffsets[VERTEXES_PER_FACE][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };		//same winding as g_topFaceVertexes
+
+	for (int cellY = 0; cellY < FAR_TERRAIN_CELLS_PER_SIDE; ++cellY)
+	{
+		for (int cellX = 0; cellX < FAR_TERRAIN_CELLS_PER_SIDE; ++cellX)
+		{
+			Vector2 cellCenter = tile->m_tileMins + Vector2(((float)cellX + 0.5f) * FAR_TERRAIN_SAMPLE_SPACING, ((float)cellY + 0.5f) * FAR_TERRAIN_SAMPLE_SPACING);
+			if (CalcDistanceSquared(cellCenter, cutoutCenter) < innerRangeSquared)
+			{
+				tile->m_hasCutout = true;
+				continue;
+			}
+
+			BlockType cellType = tile->m_surfaceTypes[cellX + (cellY * FAR_TERRAIN_SAMPLES_PER_SIDE)];
+			AABB2 texCoords = g_blockSprites->GetTexCoordsForSpriteIndex(BlockDefinition::s_blockDefinitions[cellType]->m_topSpriteIndex);
+
+			for (int cornerIndex = 0; cornerIndex < VERTEXES_PER_FACE; ++cornerIndex)
+			{
+				int sampleX = cellX + cornerOffsets[cornerIndex][0];
+				int sampleY = cellY + cornerOffsets[cornerIndex][1];
+				Vector3 cornerPosition(tile->m_tileMins.x + (float)(sampleX * FAR_TERRAIN_SAMPLE_SPACING), tile->m_tileMins.y + (float)(sampleY * FAR_TERRAIN_SAMPLE_SPACING), tile->m_surfaceHeights[sampleX + (sampleY * FAR_TERRAIN_SAMPLES_PER_SIDE)]);
+
+				const Vector2& corner = g_topFaceVertexes[cornerIndex].texCoords;
+				Vector2 cornerTexCoords(corner.x > 0.f ? texCoords.maxs.x : texCoords.mins.x, corner.y > 0.f ? texCoords.maxs.y : texCoords.mins.y);
+				vertexArray.push_back(Vertex3D(cornerPosition, cornerTexCoords, lightColor));
+			}
+		}
+	}
+
+	g_theRenderer->BindBuffer(tile->m_vboID);
+	g_theRenderer->BufferData(vertexArray.data(), vertexArray.size() * sizeof(Vertex3D));
+	g_theRenderer->BindBuffer(0);
+	tile->m_numVertexes = vertexArray.size();
+	tile->m_isMeshDirty = false;
+}
+
+bool FarTerrain::IsTileInRange(const Vector2& tileMins, const Vector2& tileMaxs, const Vector2& playerPositionXY, float rangePadding) const
+{
+	float nearestX = ClampFloat(playerPositionXY.x, tileMins.x, tileMaxs.x);
+	float nearestY = ClampFloat(playerPositionXY.y, tileMins.y, tileMaxs.y);
+	float nearestDistanceSquared = CalcDistanceSquared(playerPositionXY, Vector2(nearestX, nearestY));
+	float outerRange = FAR_TERRAIN_RANGE + rangePadding;
+	if (nearestDistanceSquared > outerRange * outerRange)
+		return false;
+
+	//Tiles that fall entirely inside the loaded chunk radius would draw nothing
+	float furthestX = (playerPositionXY.x - tileMins.x > tileMaxs.x - playerPositionXY.x) ? tileMins.x : tileMaxs.x;
+	float furthestY = (playerPositionXY.y - tileMins.y > tileMaxs.y - playerPositionXY.y) ? tileMins.y : tileMaxs.y;
+	float furthestDistanceSquared = CalcDistanceSquared(playerPositionXY, Vector2(furthestX, furthestY));
+	float innerRange = FAR_TERRAIN_INNER_RANGE - rangePadding;
+	return innerRange <= 0.f || furthestDistanceSquared >= innerRange * innerRange;
+}
+
+bool FarTerrain::DoesTileOverlapCutout(const FarTerrainTile* tile) const
+{
+	Vector2 cutoutCenter = GetCutoutCenter();
+	float nearestX = ClampFloat(cutoutCenter.x, tile->m_tileMins.x, tile->m_tileMaxs.x);
+	float nearestY = ClampFloat(cutoutCenter.y, tile->m_tileMins.y, tile->m_tileMaxs.y);
+	return CalcDistanceSquared(cutoutCenter, Vector2(nearestX, nearestY)) < FAR_TERRAIN_INNER_RANGE * FAR_TERRAIN_INNER_RANGE;
+}
+
+Vector2 FarTerrain::GetCutoutCenter() const
+{
+	return Vector2((float)((m_cutoutChunkCoords.x << CHUNK_X_BITS) + (CHUNK_X >> 1)), (float)((m_cutoutChunkCoords.y << CHUNK_Y_BITS) + (CHUNK_Y >> 1)));
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/BlockDefinition.hpp"
+#include "Game/TerrainNoise.hpp"
+#include "Engine/Math/IntVector2.hpp"
+#include "Engine/Math/Vector2.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include <map>
+#include <vector>
+
+
+constexpr int FAR_TERRAIN_TILE_BITS = 7;
+constexpr int FAR_TERRAIN_TILE_SIZE = BIT(FAR_TERRAIN_TILE_BITS);		//each tile covers 128x128 blocks
+constexpr int FAR_TERRAIN_SAMPLE_SPACING = 4;
+constexpr int FAR_TERRAIN_CELLS_PER_SIDE = FAR_TERRAIN_TILE_SIZE / FAR_TERRAIN_SAMPLE_SPACING;
+constexpr int FAR_TERRAIN_SAMPLES_PER_SIDE = FAR_TERRAIN_CELLS_PER_SIDE + 1;
+constexpr float FAR_TERRAIN_RANGE = VISIBILITY_RANGE * 4.f;
+constexpr float FAR_TERRAIN_INNER_RANGE = VISIBILITY_RANGE - 16.f;		//cells closer than this to the player's chunk are left to loaded chunks
+constexpr int FAR_TERRAIN_TILES_BUILT_PER_UPDATE = 1;
+
+
+struct FarTerrainTile
+{
+	IntVector2 m_tileCoords;
+	Vector2 m_tileMins;
+	Vector2 m_tileMaxs;
+
+	std::vector<float> m_surfaceHeights;
+	std::vector<BlockType> m_surfaceTypes;
+
+	unsigned int m_vboID;
+	unsigned int m_numVertexes;
+	bool m_isMeshDirty;
+	bool m_hasCutout;		//some cells were skipped for being inside the loaded chunk radius
+
+	FarTerrainTile(const IntVector2& tileCoords);
+	~FarTerrainTile();
+};
+
+
+class FarTerrain
+{
+public:
+	explicit FarTerrain(const TerrainNoiseSettings& noiseSettings);
+	~FarTerrain();
+
+	void Update(const Vector3& playerPosition);
+	void Render(const Vector3& cameraPosition, const Vector3& cameraForward) const;
+	void SetSkyLightLevel(unsigned int skyLightLevel);
+
+	int GetNumTiles() const;
+	int GetNumTilesDrawn() const;
+	unsigned int GetNumVertexes() const;
+	unsigned int GetNumBytes() const;
+
+private:
+	TerrainNoiseSettings m_noiseSettings;
+	std::map<IntVector2, FarTerrainTile*> m_tiles;
+	IntVector2 m_cutoutChunkCoords;
+	unsigned int m_skyLightLevel;
+	mutable int m_numTilesDrawn;
+
+	void RemoveDistantTiles(const Vector2& playerPositionXY);
+	void AddNearestMissingTiles(const Vector2& playerPositionXY);
+	void RebuildDirtyTileMeshes();
+
+	void SampleTile(FarTerrainTile* tile) const;
+	void RebuildTileMesh(FarTerrainTile* tile) const;
+
+	bool IsTileInRange(const Vector2& tileMins, const Vector2& tileMaxs, const Vector2& playerPositionXY, float rangePadding) const;
+	bool DoesTileOverlapCutout(const FarTerrainTile* tile) const;
+	Vector2 GetCutoutCenter() const;
+};
+
+
+inline int FarTerrain::GetNumTiles() const
+{
+	return (int)m_tiles.size();
+}
+
+inline int FarTerrain::GetNumTilesDrawn() const
+{
+	return m_numTilesDrawn;
+}
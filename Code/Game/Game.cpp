@@ -11,6 +11,7 @@
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/ProfileLogScope.hpp"
 #include "TreeDefinition.hpp"
+#include <limits.h>
 
 
 
@@ -64,7 +65,7 @@ void Game::Update(float deltaSeconds)
 {
 	DeveloperInput();
 	UpdatePlayer(deltaSeconds);
-	m_theWorld->Update(deltaSeconds, m_thePlayer.GetCenterPosition());
+	m_theWorld->Update(deltaSeconds, m_thePlayer.GetCenterPosition(), m_theCamera.m_position);
 	UpdateCamera(deltaSeconds);
 }
 
@@ -731,6 +732,120 @@ void Game::DrawDebugText() const
 
 		Vector2 modeInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 3));
 		g_theRenderer->DrawText2D(modeInformationPos, movementMode + " " + cameraMode, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+
+		const WorldRenderStats& renderStats = m_theWorld->GetRenderStats();
+		std::string chunksText = "Chunks Drawn: " + std::to_string(renderStats.m_numChunksDrawn) + "/" + std::to_string(m_theWorld->GetNumCurrentChunks());
+		std::string frustumText = " In Frustum: " + std::to_string(renderStats.m_numChunksInFrustum);
+		std::string cullingText = " Cull Tests: " + std::to_string(renderStats.m_numCullingTests);
+		std::string occlusionText = m_theWorld->IsOcclusionCullingEnabled() ? " Occlusion: On" : " Occlusion: Off";
+
+		std::string drawListText = m_theWorld->IsDrawListCachingEnabled() ? "Draw List: Sorted" : "Draw List: Unsorted";
+		if (renderStats.m_wasDrawListRebuilt)
+			drawListText += " (Rebuilt)";
+		std::string vertexesText = " Vertexes: " + std::to_string(renderStats.m_numVertexesDrawn) + " Out of Order: " + std::to_string(renderStats.m_numOutOfOrderVertexes);
+		std::string renderTimeText = " Visibility ms: " + std::to_string(renderStats.m_visibilitySeconds * 1000.0) + " Submit ms: " + std::to_string(renderStats.m_submissionSeconds * 1000.0);
+
+		Vector2 renderInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 4));
+		Vector2 drawListInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 5));
+		g_theRenderer->DrawText2D(renderInformationPos, chunksText + frustumText + cullingText + occlusionText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+		g_theRenderer->DrawText2D(drawListInformationPos, drawListText + vertexesText + renderTimeText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+
+		if (m_theWorld->HasDrawOrderBenchmarkResult())
+		{
+			//Out of order vertexes are drawn after a further chunk, so early depth testing can't reject them; the GPU's real overdraw isn't measured
+			const DrawOrderBenchmarkResult& drawOrderResult = m_theWorld->GetDrawOrderBenchmarkResult();
+			std::string drawOrderText = "Draw Order Benchmark Chunks: " + std::to_string(drawOrderResult.m_numChunks) + " Vertexes: " + std::to_string(drawOrderResult.m_numVertexes);
+			drawOrderText += " Out of Order Unsorted/Sorted: " + std::to_string(drawOrderResult.m_numUnsortedOutOfOrderVertexes) + "/" + std::to_string(drawOrderResult.m_numSortedOutOfOrderVertexes);
+			drawOrderText += " List ms: " + std::to_string(drawOrderResult.m_unsortedRebuildSeconds * 1000.0) + "/" + std::to_string(drawOrderResult.m_sortedRebuildSeconds * 1000.0);
+			drawOrderText += " Submit ms: " + std::to_string(drawOrderResult.m_unsortedSubmissionSeconds * 1000.0) + "/" + std::to_string(drawOrderResult.m_sortedSubmissionSeconds * 1000.0);
+			Vector2 drawOrderInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 14));
+			g_theRenderer->DrawText2D(drawOrderInformationPos, drawOrderText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+		}
+
+		std::string submissionText = "Chunk Renderer Calls: " + std::to_string(renderStats.m_numRendererCalls) + " Draw Calls: " + std::to_string(renderStats.m_numDrawCalls);
+		submissionText += m_theWorld->AreLevelsOfDetailEnabled() ? " LOD: On" : " LOD: Off";
+		for (int lodLevel = 0; lodLevel < NUM_LOD_LEVELS; ++lodLevel)
+		{
+			submissionText += (lodLevel == 0 ? " (" : "/") + std::to_string(m_theWorld->GetNumChunksAtLodLevel(lodLevel));
+		}
+		submissionText += ")";
+		Vector2 submissionInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 6));
+		g_theRenderer->DrawText2D(submissionInformationPos, submissionText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+
+		int numLoadedChunks = m_theWorld->GetNumCurrentChunks();
+		if (numLoadedChunks > 0)
+		{
+			//Quads share their corners between both triangles, so chunks draw without an index buffer
+			unsigned int numFaces = 0;
+			unsigned int numVertexBytes = 0;
+			m_theWorld->CalcLoadedChunkMeshTotals(numFaces, numVertexBytes);
+			std::string meshText = "Chunk Faces: " + std::to_string(numFaces) + " (" + std::to_string(numFaces / numLoadedChunks) + "/chunk)";
+			meshText += " Vertex KB: " + std::to_string(numVertexBytes / 1024) + " (" + std::to_string(numVertexBytes / numLoadedChunks) + " B/chunk) Index Bytes: 0";
+			Vector2 meshInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 7));
+			g_theRenderer->DrawText2D(meshInformationPos, meshText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+		}
+
+		const FarTerrain& farTerrain = m_theWorld->GetFarTerrain();
+		std::string farTerrainText = m_theWorld->IsFarTerrainEnabled() ? "Far Terrain: On" : "Far Terrain: Off";
+		farTerrainText += " Tiles: " + std::to_string(farTerrain.GetNumTilesDrawn()) + "/" + std::to_string(farTerrain.GetNumTiles()) + " Vertexes: " + std::to_string(farTerrain.GetNumVertexes()) + " KB: " + std::to_string(farTerrain.GetNumBytes() / 1024);
+		Vector2 farTerrainInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 8));
+		g_theRenderer->DrawText2D(farTerrainInformationPos, farTerrainText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+
+		const TerrainColumnCache& columnCache = m_theWorld->GetTerrainColumnCache();
+		std::string generationText = "Generation Noise/Chunk: " + std::to_string((int)columnCache.GetNoiseEvaluationsPerChunk()) + " (uncached " + std::to_string(UNCACHED_NOISE_EVALUATIONS_PER_CHUNK) + ") Cached Columns: " + std::to_string(columnCache.GetNumTiles() * BLOCKS_PER_LAYER);
+		const TerrainNoiseSettings& noiseSettings = columnCache.GetNoiseSettings();
+		generationText += noiseSettings.m_isBatchedNoiseEnabled ? " Batched Noise: On" : " Batched Noise: Off";
+		generationText += noiseSettings.m_isCoarseNoiseEnabled ? " Coarse Noise: On" : " Coarse Noise: Off";
+		const DecorationWriteStore& decorationWriteStore = m_theWorld->GetDecorationWriteStore();
+		generationText += " Pending Decoration Blocks: " + std::to_string(decorationWriteStore.GetNumPendingWrites()) + " in " + std::to_string(decorationWriteStore.GetNumPendingChunks()) + " chunks";
+		Vector2 generationInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 9));
+		g_theRenderer->DrawText2D(generationInformationPos, generationText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+
+		if (m_theWorld->HasNoiseBenchmarkResult() && m_theWorld->HasGenerationDeterminismResult())
+		{
+			const NoiseBenchmarkResult& noiseResult = m_theWorld->GetNoiseBenchmarkResult();
+			std::string generationBenchmarkText = "Generation Benchmark Samples/s: " + std::to_string((int)noiseResult.m_scalarSamplesPerSecond) + " -> " + std::to_string((int)noiseResult.m_batchedSamplesPerSecond) + " Max deviation: " + std::to_string(noiseResult.m_maxBatchedDeviation);
+			generationBenchmarkText += " Tiles/s: " + std::to_string((int)noiseResult.m_fullTilesPerSecond) + " -> " + std::to_string((int)noiseResult.m_coarseTilesPerSecond) + " Coarse deviation: " + std::to_string(noiseResult.m_maxCoarseMountainousnessDeviation) + "/" + std::to_string(noiseResult.m_maxCoarseTemperatureDeviation) + " Height: " + std::to_string(noiseResult.m_maxCoarseColumnHeightDifference);
+
+			const GenerationDeterminismResult& determinismResult = m_theWorld->GetGenerationDeterminismResult();
+			generationBenchmarkText += " Hash: " + std::to_string(determinismResult.m_generationHash) + " Reverse/Threaded Mismatches: " + std::to_string(determinismResult.m_numReverseOrderMismatches) + "/" + std::to_string(determinismResult.m_numThreadedMismatches) + " of " + std::to_string(determinismResult.m_numChunks);
+
+			const TreeSiteBenchmarkResult& treeSiteResult = m_theWorld->GetTreeSiteBenchmarkResult();
+			generationBenchmarkText += " Tree sites ms: " + std::to_string(treeSiteResult.m_localMaximaSeconds * 1000.0) + " -> " + std::to_string(treeSiteResult.m_maxFilterSeconds * 1000.0) + " Sites: " + std::to_string(treeSiteResult.m_numSites) + " Mismatches: " + std::to_string(treeSiteResult.m_numMismatches);
+
+			Vector2 generationBenchmarkInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 12));
+			g_theRenderer->DrawText2D(generationBenchmarkInformationPos, generationBenchmarkText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+		}
+
+		Vector2 generationProfileInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 13));
+		g_theRenderer->DrawText2D(generationProfileInformationPos, m_theWorld->GetGenerationProfile().GetReport(), textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+
+		const LightingWorkStats& lightingStats = m_theWorld->GetLightingStats();
+		std::string lightingText = "Lighting Dirtied: " + std::to_string(lightingStats.m_numBlocksDirtied) + " Removed: " + std::to_string(lightingStats.m_numRemovalVisits) + " Added: " + std::to_string(lightingStats.m_numAddVisits) + " Changes: " + std::to_string(lightingStats.m_numLightChanges) + " Peak queue: " + std::to_string(lightingStats.m_peakQueueDepth) + " Carried: " + std::to_string(lightingStats.m_numEntriesCarriedOver) + " Deferred: " + std::to_string(lightingStats.m_numChunkRebuildsDeferred) + " ms: " + std::to_string(lightingStats.m_seconds * 1000.0);
+		lightingText += m_theWorld->IsParallelLightingEnabled() ? " Parallel: On" : " Parallel: Off";
+		lightingText += " Sky: " + std::to_string(m_theWorld->GetSkyLightLevel());
+		lightingText += " Seeds/Activation: " + std::to_string((int)m_theWorld->GetAverageLightEntriesPerActivation());
+		lightingText += " Activation ms: " + std::to_string(m_theWorld->GetAverageActivationSeconds() * 1000.0) + " (lighting " + std::to_string(m_theWorld->GetAverageLightingInitializationSeconds() * 1000.0) + ")";
+		if (m_theWorld->HasLightingDeterminismResult())
+		{
+			lightingText += " Serial/Parallel Mismatches: " + std::to_string(m_theWorld->GetNumLightingDeterminismMismatches());
+		}
+		Vector2 lightingInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 10));
+		g_theRenderer->DrawText2D(lightingInformationPos, lightingText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+
+		if (m_theWorld->HasLightingBenchmarkResults())
+		{
+			//Blocks visited by the removal and add passes for each benchmark edit
+			const char* editNames[NUM_LIGHTING_BENCHMARK_EDITS] = { "Place Glowstone", "Remove Glowstone", "Roof Column", "Unroof Column" };
+			std::string benchmarkText = "Light Benchmark";
+			for (int editIndex = 0; editIndex < NUM_LIGHTING_BENCHMARK_EDITS; ++editIndex)
+			{
+				const LightingWorkStats& editStats = m_theWorld->GetLightingBenchmarkResult((LightingBenchmarkEdit)editIndex);
+				benchmarkText += std::string(" ") + editNames[editIndex] + ": " + std::to_string(editStats.m_numRemovalVisits + editStats.m_numAddVisits);
+			}
+			Vector2 benchmarkInformationPos = Vector2(0.f, g_GAME_HEIGHT - (textHeight * 11));
+			g_theRenderer->DrawText2D(benchmarkInformationPos, benchmarkText, textHeight, Rgba::WHITE, textAspectRatio, g_squirrelFont);
+		}
 	}
 	else
 	{
@@ -874,20 +989,7 @@ void Game::DestroyTargettedBlock(const RaycastResult& rayResults)
 		BlockInfo impactedBlock = rayResults.m_impactedBlock;
 		g_theAudio->PlaySound(BlockDefinition::s_blockDefinitions[impactedBlock.GetBlock()->GetBlockType()]->GetRandomBreakSound(), 0.5f);
 
-		impactedBlock.GetBlock()->ChangeType(BLOCK_TYPE_AIR);
-		m_theWorld->DirtyBlockLighting(impactedBlock);
-		impactedBlock.m_chunk->MakeDirty();
-		if (impactedBlock.GetAboveBlock().GetBlock()->GetIsSky())
-		{
-			impactedBlock.GetBlock()->SetIsSky();
-			BlockInfo currentBlock = impactedBlock.GetBelowBlock();
-			while (!currentBlock.GetBlock()->GetIsOpaque())
-			{
-				currentBlock.GetBlock()->SetIsSky();
-				m_theWorld->DirtyBlockLighting(currentBlock);
-				currentBlock.MoveDown();
-			}
-		}
+		m_theWorld->SetBlockType(impactedBlock, BLOCK_TYPE_AIR);
 	}
 }
 
@@ -899,23 +1001,9 @@ void Game::PlaceBlock(BlockType typeOfBlock, const RaycastResult& rayResults)
 // 		BlockInfo newBlock = m_theWorld->GetBlockInfoFromWorldCoords(rayResults.m_impactPosition + rayResults.m_impactNormal);
 		if(newBlock.m_chunk)
 		{
-			newBlock.GetBlock()->ChangeType(typeOfBlock);
-			m_theWorld->DirtyBlockLighting(newBlock);
-			newBlock.m_chunk->MakeDirty();
+			m_theWorld->SetBlockType(newBlock, typeOfBlock);
 
 			g_theAudio->PlaySound(BlockDefinition::s_blockDefinitions[typeOfBlock]->GetRandomPlaceSound(), 0.5f);
-
-			if (newBlock.GetBlock()->GetIsSky() && newBlock.GetBlock()->GetIsOpaque())
-			{
-				newBlock.GetBlock()->ClearIsSky();
-				BlockInfo currentBlock = newBlock.GetBelowBlock();
-				while (!currentBlock.GetBlock()->GetIsOpaque())
-				{
-					currentBlock.GetBlock()->ClearIsSky();
-					m_theWorld->DirtyBlockLighting(currentBlock);
-					currentBlock.MoveDown();
-				}
-			}
 		}
 	}
 }
@@ -1038,6 +1126,60 @@ void Game::DeveloperInput()
 		g_drawDebug = !g_drawDebug;
 	}
 
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F2))
+	{
+		m_theWorld->ToggleOcclusionCulling();
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F3))
+	{
+		if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
+			m_theWorld->RunDrawOrderBenchmark(m_theCamera.m_position, m_theCamera.GetForwardXYZ());
+		else
+			m_theWorld->ToggleDrawListCaching();
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F4))
+	{
+		m_theWorld->ToggleLevelsOfDetail();
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F8))
+	{
+		m_theWorld->ToggleFarTerrain();
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F9))
+	{
+		if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
+		{
+			m_theWorld->RunNoiseBenchmark();
+			m_theWorld->RunGenerationDeterminismCheck();
+			m_theWorld->RunTreeSiteBenchmark(m_thePlayer.GetCenterPosition());
+		}
+		else
+			m_theWorld->RunLightingBenchmark(m_thePlayer.GetCenterPosition());
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F10))
+	{
+		int lightingBudget = (m_theWorld->GetLightingVisitBudget() == INT_MAX) ? LIGHTING_VISITS_PER_FRAME : INT_MAX;
+		m_theWorld->SetLightingVisitBudget(lightingBudget);
+	}
+
+	if (g_theInput->WasKeyJustPressed('N'))
+	{
+		m_theWorld->ToggleDayNightCycle();
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F11))
+	{
+		if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
+			m_theWorld->RunLightingDeterminismCheck(m_thePlayer.GetCenterPosition());
+		else
+			m_theWorld->ToggleParallelLighting();
+	}
+
 }
 
 void Game::SavePlayerState()
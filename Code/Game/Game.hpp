@@ -78,13 +78,14 @@ private:
 	void ApplyGlobalForces(float deltaSeconds);
 	void DrawTargettingLine(const Vector3& startPosition, const Vector3& endPosition) const;
 	bool CheckIfPlayerIsOnGround();
-	void InitializeTrees();
 public:
 	World* m_theWorld;
 
 	Game();
 	~Game();
 
+	static void InitializeTrees();
+
 	void Update(float deltaSeconds);
 	void Render() const;
 private:
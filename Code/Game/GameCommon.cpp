@@ -14,7 +14,7 @@ int g_NUM_SELECTION_BLOCKS = 10;
 float g_HUD_BLOCK_WIDTH = g_GAME_WIDTH / (2.f * g_NUM_SELECTION_BLOCKS);
 float g_HUD_BLOCK_HEIGHT = g_HUD_BLOCK_WIDTH;
 
-int g_GAME_VERSION = 1;
+int g_GAME_VERSION = 2;		//version 1 saves predate the coarse climate lattice and trees handed across chunk borders, so they are regenerated
 
 std::string g_PLAYER_SAVE_FILE_PATH = "Data/Save/Player.sav";
 
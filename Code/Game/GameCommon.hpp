@@ -5,6 +5,9 @@
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Audio/Audio.hpp"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 class App;
 
@@ -55,7 +58,6 @@ extern BitmapFont* g_squirrelFont;
 
 constexpr int LIGHT_MASK = 0b00001111;
 constexpr int LIGHT_DIRTY_MASK = 0b10000000;
-constexpr int IS_SKY_MASK = 0b01000000;
 constexpr int IS_OPAQUE_MASK = 0b00100000;
 constexpr int IS_SOLID_MASK = 0b00010000;
 constexpr int IS_OPAQUE_AND_SOLID_MASK = IS_OPAQUE_MASK | IS_SOLID_MASK;
@@ -173,17 +175,66 @@ extern const Vertex3D g_southFaceVertexes[];
 extern const Vertex3D g_eastFaceVertexes[];
 extern const Vertex3D g_westFaceVertexes[];
 
+constexpr int VERTEXES_PER_FACE = 4;
+
 constexpr int MAXIMUM_CHUNKS = 500;
 constexpr int IDEAL_CHUNKS = 490;
 constexpr float VISIBILITY_RANGE = 175.f;
 
+constexpr float DRAW_LIST_REBUILD_MIN_FORWARD_DOT = 0.966f;		//rebuild the cached draw list after turning roughly 15 degrees
+constexpr float DRAW_LIST_CULLING_MARGIN = 24.f;
+constexpr int DRAW_ORDER_BENCHMARK_REPEATS = 16;
+
+constexpr int NUM_LOD_LEVELS = 3;
+constexpr float LOD_DISTANCES[NUM_LOD_LEVELS] = { 0.f, 64.f, 112.f };		//chunks past each distance are meshed at 1, 2 and 4 blocks per cell
+constexpr float LOD_HYSTERESIS = 8.f;		//a chunk must come this much closer before it goes back to a finer mesh
+
 constexpr unsigned int SKY_LIGHT_VALUE = 15;
+constexpr int SKY_LIGHT_SHIFT = 4;		//packed light keeps sky light in the high nibble and block light in the low one
+constexpr float DAY_LENGTH_SECONDS = 240.f;
+constexpr unsigned int NIGHT_SKY_LIGHT_LEVEL = 4;		//darkest the sky gets at midnight
+constexpr int LIGHTING_VISITS_PER_FRAME = 32768;		//default lighting budget, leftover work carries over to the next frame
+constexpr int LIGHTING_PRIORITY_CHUNK_RADIUS = 2;		//light additions this close to the player's chunk are processed first
 
 constexpr unsigned char LIGHT_RGBA_VALUES[16] = 
 {
 	20, 35, 50, 65, 80, 95, 110, 125, 140, 155, 175, 195, 210, 225, 240, 255
 };
 
+enum LightChannel
+{
+	LIGHT_CHANNEL_BLOCK,
+	LIGHT_CHANNEL_SKY,
+	NUM_LIGHT_CHANNELS
+};
+
+//Index of the lowest set bit, value must not be zero
+inline int CountTrailingZeros(unsigned int value)
+{
+#if defined(_MSC_VER)
+	unsigned long bitIndex;
+	_BitScanForward(&bitIndex, value);
+	return (int)bitIndex;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+inline unsigned char PackLightValues(unsigned int skyLightValue, unsigned int blockLightValue)
+{
+	return (unsigned char)((skyLightValue << SKY_LIGHT_SHIFT) | blockLightValue);
+}
+
+//Sky light is dimmed by however far the sky is below full brightness, block light is unaffected
+inline unsigned int CalcVisibleLightValue(unsigned char packedLightValues, unsigned int skyLightLevel)
+{
+	unsigned int skyLightValue = packedLightValues >> SKY_LIGHT_SHIFT;
+	unsigned int blockLightValue = packedLightValues & ((1 << SKY_LIGHT_SHIFT) - 1);
+	unsigned int skyDarkening = SKY_LIGHT_VALUE - skyLightLevel;
+	skyLightValue = (skyLightValue > skyDarkening) ? skyLightValue - skyDarkening : 0;
+	return (skyLightValue > blockLightValue) ? skyLightValue : blockLightValue;
+}
+
 constexpr int CHUNK_X_BITS = 4;
 constexpr int CHUNK_Y_BITS = 4;
 constexpr int CHUNK_Z_BITS = 7;
@@ -199,7 +250,13 @@ constexpr int Z_MASK_BITS = (CHUNK_Z - 1) << CHUNK_XY_BITS;
 constexpr int BLOCKS_PER_LAYER = CHUNK_X * CHUNK_Y;
 constexpr int BLOCKS_PER_CHUNK = BLOCKS_PER_LAYER * CHUNK_Z;
 
+constexpr int CHUNK_SECTION_Z_BITS = 4;
+constexpr int CHUNK_SECTION_Z = BIT(CHUNK_SECTION_Z_BITS);
+constexpr int SECTIONS_PER_CHUNK = CHUNK_Z / CHUNK_SECTION_Z;
+constexpr int BLOCKS_PER_SECTION = BLOCKS_PER_LAYER * CHUNK_SECTION_Z;
+
 constexpr int SEA_LEVEL = CHUNK_Z / 2;
+constexpr unsigned int WORLD_SEED = 0;		//added to every terrain noise seed, zero keeps the original terrain
 constexpr int STONE_OFFSET = 0;
 constexpr int DIRT_OFFSET = 4;
 constexpr int GRASS_OFFSET = DIRT_OFFSET + 1;
@@ -0,0 +1,80 @@
+#include "Game/GenerationProfile.hpp"
+
+
+const char* GetGenerationStageName(GenerationStage stage)
+{
+	switch (stage)
+	{
+	case GENERATION_STAGE_CLIMATE:
+		return "Climate";
+	case GENERATION_STAGE_HEIGHTMAP:
+		return "Heightmap";
+	case GENERATION_STAGE_STRATA:
+		return "Strata";
+	case GENERATION_STAGE_DECORATION:
+		return "Decoration";
+	default:
+		return "Unknown";
+	}
+}
+
+
+GenerationProfile::GenerationProfile()
+	: m_numChunks(0)
+{
+	for (int stageIndex = 0; stageIndex < NUM_GENERATION_STAGES; ++stageIndex)
+	{
+		m_stageSeconds[stageIndex] = 0.0;
+		m_numStageRuns[stageIndex] = 0;
+	}
+}
+
+void GenerationProfile::AddStageSeconds(GenerationStage stage, double seconds)
+{
+	m_stageSeconds[stage] += seconds;
+	++m_numStageRuns[stage];
+}
+
+void GenerationProfile::Add(const GenerationProfile& otherProfile)
+{
+	for (int stageIndex = 0; stageIndex < NUM_GENERATION_STAGES; ++stageIndex)
+	{
+		m_stageSeconds[stageIndex] += otherProfile.m_stageSeconds[stageIndex];
+		m_numStageRuns[stageIndex] += otherProfile.m_numStageRuns[stageIndex];
+	}
+	m_numChunks += otherProfile.m_numChunks;
+}
+
+double GenerationProfile::GetTotalSeconds() const
+{
+	double totalSeconds = 0.0;
+	for (int stageIndex = 0; stageIndex < NUM_GENERATION_STAGES; ++stageIndex)
+	{
+		totalSeconds += m_stageSeconds[stageIndex];
+	}
+	return totalSeconds;
+}
+
+double GenerationProfile::GetMillisecondsPerChunk(GenerationStage stage) const
+{
+	//Tile stages are shared between neighboring chunks, so this is their cost amortized over the chunks that used them
+	if (m_numChunks == 0)
+		return 0.0;
+	return (m_stageSeconds[stage] * 1000.0) / (double)m_numChunks;
+}
+
+std::string GenerationProfile::GetReport() const
+{
+	double totalSeconds = GetTotalSeconds();
+	std::string report = "Generation Profile Chunks: " + std::to_string(m_numChunks) + " ms/chunk";
+	for (int stageIndex = 0; stageIndex < NUM_GENERATION_STAGES; ++stageIndex)
+	{
+		GenerationStage stage = (GenerationStage)stageIndex;
+		int stagePercent = (totalSeconds > 0.0) ? (int)((m_stageSeconds[stageIndex] * 100.0) / totalSeconds) : 0;
+		report += " " + std::string(GetGenerationStageName(stage)) + ": " + std::to_string(GetMillisecondsPerChunk(stage)) + " (" + std::to_string(stagePercent) + "%, " + std::to_string(m_numStageRuns[stageIndex]) + " runs)";
+	}
+
+	double totalMilliseconds = (m_numChunks > 0) ? ((totalSeconds * 1000.0) / (double)m_numChunks) : 0.0;
+	report += " Total: " + std::to_string(totalMilliseconds);
+	return report;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+
+
+//Chunk generation runs these in order, climate and heightmap per column tile in the column cache, strata and decoration per chunk
+enum GenerationStage
+{
+	GENERATION_STAGE_CLIMATE,
+	GENERATION_STAGE_HEIGHTMAP,
+	GENERATION_STAGE_STRATA,
+	GENERATION_STAGE_DECORATION,
+	NUM_GENERATION_STAGES
+};
+
+const char* GetGenerationStageName(GenerationStage stage);
+
+
+//Time spent in each generation stage, summed over every chunk generated with it
+struct GenerationProfile
+{
+	double m_stageSeconds[NUM_GENERATION_STAGES];
+	int m_numStageRuns[NUM_GENERATION_STAGES];
+	int m_numChunks;
+
+	GenerationProfile();
+
+	void AddStageSeconds(GenerationStage stage, double seconds);
+	void Add(const GenerationProfile& otherProfile);
+	double GetTotalSeconds() const;
+	double GetMillisecondsPerChunk(GenerationStage stage) const;
+	std::string GetReport() const;
+};
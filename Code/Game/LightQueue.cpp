@@ -0,0 +1,24 @@
+#include "Game/LightQueue.hpp"
+
+
+LightQueue::LightQueue()
+	: m_entries(LIGHT_QUEUE_INITIAL_CAPACITY)
+	, m_headIndex(0)
+	, m_numEntries(0)
+	, m_peakSize(0)
+{
+
+}
+
+void LightQueue::Grow()
+{
+	//Unwrap into a buffer twice the size so the entries are contiguous from the start again
+	std::vector<unsigned int> grownEntries(m_entries.size() * 2);
+	for (unsigned int entryIndex = 0; entryIndex < m_numEntries; ++entryIndex)
+	{
+		grownEntries[entryIndex] = m_entries[(m_headIndex + entryIndex) & (m_entries.size() - 1)];
+	}
+
+	m_entries.swap(grownEntries);
+	m_headIndex = 0;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <vector>
+
+
+//Entries pack a block index, the lighting slot of its chunk, the light channel and, for removals, the light value it had
+constexpr int LIGHT_ENTRY_BLOCK_INDEX_BITS = CHUNK_XY_BITS + CHUNK_Z_BITS;
+constexpr int LIGHT_ENTRY_SLOT_BITS = 12;
+constexpr int LIGHT_ENTRY_CHANNEL_BITS = 1;
+constexpr int LIGHT_ENTRY_LIGHT_VALUE_BITS = 4;
+constexpr int LIGHT_ENTRY_CHANNEL_SHIFT = LIGHT_ENTRY_BLOCK_INDEX_BITS + LIGHT_ENTRY_SLOT_BITS;
+constexpr int LIGHT_ENTRY_LIGHT_VALUE_SHIFT = LIGHT_ENTRY_CHANNEL_SHIFT + LIGHT_ENTRY_CHANNEL_BITS;
+constexpr int MAX_LIGHTING_SLOTS = BIT(LIGHT_ENTRY_SLOT_BITS);
+
+constexpr unsigned int LIGHT_ENTRY_BLOCK_INDEX_MASK = BIT(LIGHT_ENTRY_BLOCK_INDEX_BITS) - 1;
+constexpr unsigned int LIGHT_ENTRY_SLOT_MASK = BIT(LIGHT_ENTRY_SLOT_BITS) - 1;
+constexpr unsigned int LIGHT_ENTRY_CHANNEL_MASK = BIT(LIGHT_ENTRY_CHANNEL_BITS) - 1;
+constexpr unsigned int LIGHT_ENTRY_LIGHT_VALUE_MASK = BIT(LIGHT_ENTRY_LIGHT_VALUE_BITS) - 1;
+
+constexpr int LIGHT_QUEUE_INITIAL_CAPACITY = 16384;
+
+
+class LightQueue
+{
+public:
+	LightQueue();
+
+	void Push(unsigned int entry);
+	unsigned int Pop();
+	bool IsEmpty() const;
+	int GetSize() const;
+
+	int GetPeakSize() const;
+	void ResetPeakSize();
+
+private:
+	std::vector<unsigned int> m_entries;		//ring buffer, capacity is always a power of two
+	unsigned int m_headIndex;
+	unsigned int m_numEntries;
+	int m_peakSize;
+
+	void Grow();
+};
+
+
+inline unsigned int PackLightEntry(int chunkSlot, int blockIndex, LightChannel channel, unsigned int lightValue = 0)
+{
+	return (unsigned int)blockIndex | ((unsigned int)chunkSlot << LIGHT_ENTRY_BLOCK_INDEX_BITS) | ((unsigned int)channel << LIGHT_ENTRY_CHANNEL_SHIFT) | (lightValue << LIGHT_ENTRY_LIGHT_VALUE_SHIFT);
+}
+
+inline int GetLightEntryBlockIndex(unsigned int entry)
+{
+	return (int)(entry & LIGHT_ENTRY_BLOCK_INDEX_MASK);
+}
+
+inline int GetLightEntryChunkSlot(unsigned int entry)
+{
+	return (int)((entry >> LIGHT_ENTRY_BLOCK_INDEX_BITS) & LIGHT_ENTRY_SLOT_MASK);
+}
+
+inline LightChannel GetLightEntryChannel(unsigned int entry)
+{
+	return (LightChannel)((entry >> LIGHT_ENTRY_CHANNEL_SHIFT) & LIGHT_ENTRY_CHANNEL_MASK);
+}
+
+inline unsigned int GetLightEntryLightValue(unsigned int entry)
+{
+	return (entry >> LIGHT_ENTRY_LIGHT_VALUE_SHIFT) & LIGHT_ENTRY_LIGHT_VALUE_MASK;
+}
+
+
+inline void LightQueue::Push(unsigned int entry)
+{
+	if (m_numEntries == m_entries.size())
+	{
+		Grow();
+	}
+
+	m_entries[(m_headIndex + m_numEntries) & (m_entries.size() - 1)] = entry;
+	++m_numEntries;
+	if ((int)m_numEntries > m_peakSize)
+	{
+		m_peakSize = (int)m_numEntries;
+	}
+}
+
+inline unsigned int LightQueue::Pop()
+{
+	unsigned int entry = m_entries[m_headIndex];
+	m_headIndex = (m_headIndex + 1) & (m_entries.size() - 1);
+	--m_numEntries;
+	return entry;
+}
+
+inline bool LightQueue::IsEmpty() const
+{
+	return m_numEntries == 0;
+}
+
+inline int LightQueue::GetSize() const
+{
+	return (int)m_numEntries;
+}
+
+inline int LightQueue::GetPeakSize() const
+{
+	return m_peakSize;
+}
+
+inline void LightQueue::ResetPeakSize()
+{
+	m_peakSize = (int)m_numEntries;
+}
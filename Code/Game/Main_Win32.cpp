@@ -8,6 +8,11 @@
 #include "Game/App.hpp"
 #include <time.h>
 #include "Engine/Core/ProfileLogScope.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Game/Game.hpp"
+#include "Game/TerrainNoise.hpp"
+#include "Game/WorldPregenerator.hpp"
 
 
 //-----------------------------------------------------------------------------------------------
@@ -230,10 +235,38 @@ void Shutdown()
 }
 
 
+//-----------------------------------------------------------------------------------------------
+int RunWorldPregeneration( const PregenerationRegion& region )
+{
+	//Headless, generation only needs the tree shapes, no window, renderer or block definitions
+	Game::InitializeTrees();
+
+	TerrainGenerator generator( ChooseTerrainNoiseSettings( WORLD_SEED ) );
+	PregenerationResult result = PregenerateWorldRegion( generator, region );
+
+	std::string report = result.GetReport();
+	DebuggerPrintf( "%s", report.c_str() );
+	WriteBufferToFile( std::vector<unsigned char>( report.begin(), report.end() ), PREGENERATION_REPORT_FILE_PATH );
+	return ( result.m_numWriteFailures == 0 ) ? 0 : 1;
+}
+
+
 //-----------------------------------------------------------------------------------------------
 int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR commandLineString, int )
 {
-	UNUSED( commandLineString );
+	PregenerationRegion pregenerationRegion;
+	PregenerationCommandLine pregenerationCommandLine = ParsePregenerationCommandLine( commandLineString, pregenerationRegion );
+	if ( pregenerationCommandLine == PREGENERATION_COMMAND_LINE_VALID )
+		return RunWorldPregeneration( pregenerationRegion );
+
+	if ( pregenerationCommandLine == PREGENERATION_COMMAND_LINE_INVALID )
+	{
+		//Asked for a headless run, so report the mistake where the run's report would go instead of opening the game
+		DebuggerPrintf( "%s", PREGENERATION_USAGE.c_str() );
+		WriteBufferToFile( std::vector<unsigned char>( PREGENERATION_USAGE.begin(), PREGENERATION_USAGE.end() ), PREGENERATION_REPORT_FILE_PATH );
+		return 2;
+	}
+
 	Initialize( applicationInstanceHandle );
 
 	while( !g_theApp->IsQuitting() )
@@ -0,0 +1,32 @@
+#include "Game/RecordingRenderer.hpp"
+
+
+RecordingRenderer::RecordingRenderer(Renderer* renderer)
+	: m_renderer(renderer)
+	, m_boundVBOID(0)
+	, m_numBindBufferCalls(0)
+	, m_numVertexesDrawn(0)
+	, m_draws()
+{
+
+}
+
+void RecordingRenderer::BindBuffer(unsigned int vboID)
+{
+	++m_numBindBufferCalls;
+	m_boundVBOID = vboID;
+	if (m_renderer)
+	{
+		m_renderer->BindBuffer(vboID);
+	}
+}
+
+void RecordingRenderer::DrawVBO(int numVertexes, PrimitiveType primitiveType)
+{
+	m_draws.push_back(RecordedDraw(m_boundVBOID, numVertexes));
+	m_numVertexesDrawn += numVertexes;
+	if (m_renderer)
+	{
+		m_renderer->DrawVBO(numVertexes, primitiveType);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "Engine/Renderer/Renderer.hpp"
+#include <vector>
+
+
+//One DrawVBO call, with the buffer that was bound when it was made
+struct RecordedDraw
+{
+	unsigned int m_vboID;
+	int m_numVertexes;
+
+	RecordedDraw(unsigned int vboID, int numVertexes);
+};
+
+
+//Stands in for the Renderer on the chunk submission path, counting every call before passing it on
+//Without a renderer to pass calls to it only records, so a submission can be measured without drawing it
+class RecordingRenderer
+{
+public:
+	explicit RecordingRenderer(Renderer* renderer);
+
+	void BindBuffer(unsigned int vboID);
+	void DrawVBO(int numVertexes, PrimitiveType primitiveType);
+
+	int GetNumCalls() const;
+	int GetNumBindBufferCalls() const;
+	int GetNumDrawCalls() const;
+	int GetNumVertexesDrawn() const;
+	const std::vector<RecordedDraw>& GetDraws() const;
+
+private:
+	Renderer* m_renderer;
+	unsigned int m_boundVBOID;
+	int m_numBindBufferCalls;
+	int m_numVertexesDrawn;
+	std::vector<RecordedDraw> m_draws;
+};
+
+
+inline RecordedDraw::RecordedDraw(unsigned int vboID, int numVertexes)
+	: m_vboID(vboID)
+	, m_numVertexes(numVertexes)
+{
+
+}
+
+inline int RecordingRenderer::GetNumCalls() const
+{
+	return m_numBindBufferCalls + (int)m_draws.size();
+}
+
+inline int RecordingRenderer::GetNumBindBufferCalls() const
+{
+	return m_numBindBufferCalls;
+}
+
+inline int RecordingRenderer::GetNumDrawCalls() const
+{
+	return (int)m_draws.size();
+}
+
+inline int RecordingRenderer::GetNumVertexesDrawn() const
+{
+	return m_numVertexesDrawn;
+}
+
+inline const std::vector<RecordedDraw>& RecordingRenderer::GetDraws() const
+{
+	return m_draws;
+}
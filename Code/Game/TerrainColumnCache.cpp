@@ -0,0 +1,151 @@
+#include "Game/TerrainColumnCache.hpp"
+#include "Game/TerrainNoise.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Time.hpp"
+
+
+TerrainColumnCache::TerrainColumnCache(const TerrainNoiseSettings& noiseSettings)
+	: m_noiseSettings(noiseSettings)
+	, m_tiles()
+	, m_numNoiseEvaluations(0)
+	, m_numChunksGathered(0)
+{
+
+}
+
+TerrainColumnCache::~TerrainColumnCache()
+{
+	for (std::map<IntVector2, TerrainColumnTile*>::iterator tileIter = m_tiles.begin(); tileIter != m_tiles.end(); ++tileIter)
+	{
+		delete tileIter->second;
+	}
+	m_tiles.clear();
+}
+
+void TerrainColumnCache::GatherColumns(const IntVector2& chunkCoords, int padding, TerrainColumn* out_columns, GenerationProfile* profile)
+{
+	ASSERT_OR_DIE(padding <= TERRAIN_COLUMN_CACHE_MAX_PADDING, "Terrain column padding reaches past the neighboring chunks");
+
+	//Padding never reaches past the adjacent chunks, so look up the 3x3 tiles once instead of per column
+	const TerrainColumnTile* tiles[3][3];
+	for (int tileY = 0; tileY < 3; ++tileY)
+	{
+		for (int tileX = 0; tileX < 3; ++tileX)
+		{
+			tiles[tileY][tileX] = GetOrComputeTile(IntVector2(chunkCoords.x + tileX - 1, chunkCoords.y + tileY - 1), profile);
+		}
+	}
+
+	int paddedWidth = CHUNK_X + (2 * padding);
+	for (int yIndex = -padding; yIndex < CHUNK_Y + padding; ++yIndex)
+	{
+		int tileY = (yIndex + CHUNK_Y) >> CHUNK_Y_BITS;
+		int localY = (yIndex + CHUNK_Y) & (CHUNK_Y - 1);
+		for (int xIndex = -padding; xIndex < CHUNK_X + padding; ++xIndex)
+		{
+			int tileX = (xIndex + CHUNK_X) >> CHUNK_X_BITS;
+			int localX = (xIndex + CHUNK_X) & (CHUNK_X - 1);
+			out_columns[(xIndex + padding) + ((yIndex + padding) * paddedWidth)] = tiles[tileY][tileX]->m_columns[localX + (localY << CHUNK_X_BITS)];
+		}
+	}
+	++m_numChunksGathered;
+}
+
+void TerrainColumnCache::EvictTile(const IntVector2& chunkCoords)
+{
+	std::map<IntVector2, TerrainColumnTile*>::iterator found = m_tiles.find(chunkCoords);
+	if (found == m_tiles.end())
+		return;
+
+	delete found->second;
+	m_tiles.erase(found);
+}
+
+const TerrainColumnTile* TerrainColumnCache::GetOrComputeTile(const IntVector2& chunkCoords, GenerationProfile* profile)
+{
+	std::map<IntVector2, TerrainColumnTile*>::iterator found = m_tiles.find(chunkCoords);
+	if (found != m_tiles.end())
+		return found->second;
+
+	TerrainColumnTile* newTile = new TerrainColumnTile();
+	m_numNoiseEvaluations += ComputeTile(m_noiseSettings, chunkCoords, *newTile, profile);
+
+	m_tiles[chunkCoords] = newTile;
+	return newTile;
+}
+
+int TerrainColumnCache::ComputeTile(const TerrainNoiseSettings& settings, const IntVector2& chunkCoords, TerrainColumnTile& out_tile, GenerationProfile* profile)
+{
+	if (profile == nullptr)
+		return ComputeClimateStage(settings, chunkCoords, out_tile) + ComputeHeightmapStage(settings, chunkCoords, out_tile);
+
+	double startSeconds = GetCurrentTimeSeconds();
+	int numNoiseEvaluations = ComputeClimateStage(settings, chunkCoords, out_tile);
+	double climateEndSeconds = GetCurrentTimeSeconds();
+	numNoiseEvaluations += ComputeHeightmapStage(settings, chunkCoords, out_tile);
+	double heightmapEndSeconds = GetCurrentTimeSeconds();
+
+	profile->AddStageSeconds(GENERATION_STAGE_CLIMATE, climateEndSeconds - startSeconds);
+	profile->AddStageSeconds(GENERATION_STAGE_HEIGHTMAP, heightmapEndSeconds - climateEndSeconds);
+	return numNoiseEvaluations;
+}
+
+int TerrainColumnCache::ComputeClimateStage(const TerrainNoiseSettings& settings, const IntVector2& chunkCoords, TerrainColumnTile& out_tile)
+{
+	float tileMinX = (float)(chunkCoords.x * CHUNK_X);
+	float tileMinY = (float)(chunkCoords.y * CHUNK_Y);
+
+	//Mountainousness and temperature change slowly enough to come from a coarse lattice for the whole tile
+	float mountainousness[BLOCKS_PER_LAYER];
+	float temperatures[BLOCKS_PER_LAYER];
+	ComputeLowFrequencyFieldTile(settings, TERRAIN_NOISE_MOUNTAINOUSNESS, tileMinX, tileMinY, mountainousness);
+	ComputeLowFrequencyFieldTile(settings, TERRAIN_NOISE_TEMPERATURE, tileMinX, tileMinY, temperatures);
+
+	float wetness[CHUNK_X];
+	float treeValues[CHUNK_X];
+	for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+	{
+		float worldY = tileMinY + (float)yIndex;
+		ComputeWetnessRow(settings, tileMinX, worldY, CHUNK_X, wetness);
+		ComputeTreeValueRow(settings, tileMinX, worldY, CHUNK_X, wetness, treeValues);
+
+		for (int xIndex = 0; xIndex < CHUNK_X; ++xIndex)
+		{
+			int columnIndex = xIndex + (yIndex << CHUNK_X_BITS);
+			TerrainColumn& column = out_tile.m_columns[columnIndex];
+			column.m_mountainousness = mountainousness[columnIndex];
+			column.m_wetness = wetness[xIndex];
+			column.m_temperature = temperatures[columnIndex];
+			column.m_treeValue = treeValues[xIndex];
+		}
+	}
+
+	int numLowFrequencySamples = settings.m_isCoarseNoiseEnabled ? (COARSE_NOISE_SAMPLES_PER_SIDE * COARSE_NOISE_SAMPLES_PER_SIDE) : BLOCKS_PER_LAYER;
+	return (2 * numLowFrequencySamples) + (BLOCKS_PER_LAYER * (NUM_TERRAIN_NOISE_FIELDS - 3));
+}
+
+int TerrainColumnCache::ComputeHeightmapStage(const TerrainNoiseSettings& settings, const IntVector2& chunkCoords, TerrainColumnTile& out_tile)
+{
+	//Needs the climate stage's mountainousness in the tile already
+	float tileMinX = (float)(chunkCoords.x * CHUNK_X);
+	float tileMinY = (float)(chunkCoords.y * CHUNK_Y);
+
+	float rowMountainousness[CHUNK_X];
+	int columnHeights[CHUNK_X];
+	for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+	{
+		TerrainColumn* rowColumns = out_tile.m_columns + (yIndex << CHUNK_X_BITS);
+		for (int xIndex = 0; xIndex < CHUNK_X; ++xIndex)
+		{
+			rowMountainousness[xIndex] = rowColumns[xIndex].m_mountainousness;
+		}
+
+		ComputeColumnHeightRow(settings, tileMinX, tileMinY + (float)yIndex, CHUNK_X, rowMountainousness, columnHeights);
+		for (int xIndex = 0; xIndex < CHUNK_X; ++xIndex)
+		{
+			rowColumns[xIndex].m_columnHeight = columnHeights[xIndex];
+		}
+	}
+
+	return BLOCKS_PER_LAYER;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/GenerationProfile.hpp"
+#include "Game/TerrainNoise.hpp"
+#include "Engine/Math/IntVector2.hpp"
+#include <map>
+
+
+constexpr int TERRAIN_COLUMN_CACHE_MAX_PADDING = CHUNK_X;
+constexpr int UNCACHED_NOISE_EVALUATIONS_PER_CHUNK = (3 * (CHUNK_X + 8) * (CHUNK_Y + 8)) + (2 * (CHUNK_X + 10) * (CHUNK_Y + 10));		//each chunk sampling its own padded grids
+
+
+//Noise results for one column of blocks
+struct TerrainColumn
+{
+	float m_mountainousness;
+	int m_columnHeight;
+	float m_wetness;
+	float m_temperature;
+	float m_treeValue;
+};
+
+
+//Noise columns for the blocks of one chunk
+struct TerrainColumnTile
+{
+	TerrainColumn m_columns[BLOCKS_PER_LAYER];
+};
+
+
+//Noise columns shared by neighboring chunks, so the padding each chunk samples around itself is only evaluated once
+class TerrainColumnCache
+{
+public:
+	explicit TerrainColumnCache(const TerrainNoiseSettings& noiseSettings);
+	~TerrainColumnCache();
+
+	void GatherColumns(const IntVector2& chunkCoords, int padding, TerrainColumn* out_columns, GenerationProfile* profile = nullptr);
+	void EvictTile(const IntVector2& chunkCoords);
+
+	const TerrainNoiseSettings& GetNoiseSettings() const;
+	unsigned int GetWorldSeed() const;
+	int GetNumTiles() const;
+	int GetNumNoiseEvaluations() const;
+	float GetNoiseEvaluationsPerChunk() const;
+
+	static int ComputeTile(const TerrainNoiseSettings& settings, const IntVector2& chunkCoords, TerrainColumnTile& out_tile, GenerationProfile* profile = nullptr);
+	static int ComputeClimateStage(const TerrainNoiseSettings& settings, const IntVector2& chunkCoords, TerrainColumnTile& out_tile);
+	static int ComputeHeightmapStage(const TerrainNoiseSettings& settings, const IntVector2& chunkCoords, TerrainColumnTile& out_tile);
+
+private:
+	TerrainNoiseSettings m_noiseSettings;
+	std::map<IntVector2, TerrainColumnTile*> m_tiles;
+	int m_numNoiseEvaluations;
+	int m_numChunksGathered;
+
+	const TerrainColumnTile* GetOrComputeTile(const IntVector2& chunkCoords, GenerationProfile* profile);
+};
+
+
+inline const TerrainNoiseSettings& TerrainColumnCache::GetNoiseSettings() const
+{
+	return m_noiseSettings;
+}
+
+inline unsigned int TerrainColumnCache::GetWorldSeed() const
+{
+	return m_noiseSettings.m_worldSeed;
+}
+
+inline int TerrainColumnCache::GetNumTiles() const
+{
+	return (int)m_tiles.size();
+}
+
+inline int TerrainColumnCache::GetNumNoiseEvaluations() const
+{
+	return m_numNoiseEvaluations;
+}
+
+inline float TerrainColumnCache::GetNoiseEvaluationsPerChunk() const
+{
+	if (m_numChunksGathered == 0)
+		return 0.f;
+	return (float)m_numNoiseEvaluations / (float)m_numChunksGathered;
+}
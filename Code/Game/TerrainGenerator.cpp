@@ -0,0 +1,462 @@
+#include "Game/TerrainGenerator.hpp"
+#include "Game/TerrainNoise.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <atomic>
+#include <map>
+#include <thread>
+#include <vector>
+
+
+TreeSiteBenchmarkResult::TreeSiteBenchmarkResult()
+	: m_localMaximaSeconds(0.0)
+	, m_maxFilterSeconds(0.0)
+	, m_numSites(0)
+	, m_numMismatches(0)
+{
+
+}
+
+
+GenerationDeterminismResult::GenerationDeterminismResult()
+	: m_generationHash(0)
+	, m_numChunks(0)
+	, m_numReverseOrderMismatches(0)
+	, m_numThreadedMismatches(0)
+	, m_numThreads(0)
+{
+
+}
+
+
+TerrainGenerator::TerrainGenerator(const TerrainNoiseSettings& noiseSettings)
+	: m_noiseSettings(noiseSettings)
+{
+
+}
+
+void TerrainGenerator::GenerateChunk(const IntVector2& chunkCoords, TerrainColumnCache& columnCache, BlockType* out_blockTypes, std::vector<DecorationWrite>& out_outsideWrites, GenerationProfile* profile) const
+{
+	ASSERT_OR_DIE(columnCache.GetNoiseSettings() == m_noiseSettings, "Terrain column cache was filled with different noise settings");
+
+	//Climate and heightmap stages run inside the column cache, only for tiles it hasn't kept
+	TerrainColumn columns[GENERATION_COLUMNS_SIZE];
+	columnCache.GatherColumns(chunkCoords, GENERATION_COLUMN_PADDING, columns, profile);
+
+	if (profile == nullptr)
+	{
+		FillStrata(columns, out_blockTypes);
+		Decorate(chunkCoords, columns, out_blockTypes, out_outsideWrites);
+		return;
+	}
+
+	double startSeconds = GetCurrentTimeSeconds();
+	FillStrata(columns, out_blockTypes);
+	double strataEndSeconds = GetCurrentTimeSeconds();
+	Decorate(chunkCoords, columns, out_blockTypes, out_outsideWrites);
+	double decorationEndSeconds = GetCurrentTimeSeconds();
+
+	profile->AddStageSeconds(GENERATION_STAGE_STRATA, strataEndSeconds - startSeconds);
+	profile->AddStageSeconds(GENERATION_STAGE_DECORATION, decorationEndSeconds - strataEndSeconds);
+	++profile->m_numChunks;
+}
+
+void TerrainGenerator::FillStrata(const TerrainColumn* columns, BlockType* out_blockTypes)
+{
+	//Strata boundaries are worked out once per column and written as runs, so the fill cost is per column rather than per block
+	for (int yIndex = 0; yIndex < CHUNK_Y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < CHUNK_X; xIndex++)
+		{
+			const TerrainColumn& column = columns[(xIndex + GENERATION_COLUMN_PADDING) + ((yIndex + GENERATION_COLUMN_PADDING) * GENERATION_COLUMNS_WIDTH)];
+			int columnHeight = column.m_columnHeight;
+			int stoneTop = ClampInt(columnHeight + STONE_OFFSET, 0, CHUNK_Z);
+			int dirtTop = ClampInt(columnHeight + DIRT_OFFSET, stoneTop, CHUNK_Z);
+			int surfaceTop = ClampInt(columnHeight + GRASS_OFFSET, dirtTop, CHUNK_Z);
+			int waterTop = ClampInt(SEA_LEVEL + 1, surfaceTop, CHUNK_Z);
+
+			//Below sea level the dirt band is sand, deserts are sand all the way up
+			int sandTop = IsDesert(column.m_wetness, column.m_temperature) ? dirtTop : ClampInt(SEA_LEVEL + 1, stoneTop, dirtTop);
+
+			BlockType* columnBlockTypes = out_blockTypes + xIndex + (yIndex * CHUNK_X);
+			FillColumnRun(columnBlockTypes, 0, stoneTop, BLOCK_TYPE_STONE);
+			FillColumnRun(columnBlockTypes, stoneTop, sandTop, BLOCK_TYPE_SAND);
+			FillColumnRun(columnBlockTypes, sandTop, dirtTop, BLOCK_TYPE_DIRT);
+			FillColumnRun(columnBlockTypes, dirtTop, surfaceTop, GetSurfaceBlockType(dirtTop, column.m_wetness, column.m_temperature));
+			FillColumnRun(columnBlockTypes, surfaceTop, waterTop, BLOCK_TYPE_WATER);
+			FillColumnRun(columnBlockTypes, waterTop, CHUNK_Z, BLOCK_TYPE_AIR);
+		}
+	}
+}
+
+void TerrainGenerator::Decorate(const IntVector2& chunkCoords, const TerrainColumn* columns, BlockType* out_blockTypes, std::vector<DecorationWrite>& out_outsideWrites)
+{
+	float treeValues[GENERATION_COLUMNS_SIZE];
+	for (int columnIndex = 0; columnIndex < GENERATION_COLUMNS_SIZE; ++columnIndex)
+	{
+		treeValues[columnIndex] = columns[columnIndex].m_treeValue;
+	}
+
+	int treeSites[MAX_TREE_SITES];
+	int numTreeSites = FindTreeSites(treeValues, treeSites);
+	for (int siteIndex = 0; siteIndex < numTreeSites; ++siteIndex)
+	{
+		int columnIndex = treeSites[siteIndex];
+		int columnHeight = (columns[columnIndex].m_columnHeight + GRASS_OFFSET);
+		if (columnHeight <= SEA_LEVEL)
+			continue;
+
+		int xIndex = (columnIndex % GENERATION_COLUMNS_WIDTH) - GENERATION_COLUMN_PADDING;
+		int yIndex = (columnIndex / GENERATION_COLUMNS_WIDTH) - GENERATION_COLUMN_PADDING;
+		float columnTemperature = columns[columnIndex].m_temperature;
+		if (columnTemperature > 80.f)
+			TreeDefinition::s_treeDefinitions[TREE_TYPE_WIMBA]->StampIntoChunk(chunkCoords, xIndex, yIndex, columnHeight, out_blockTypes, out_outsideWrites);
+		else if (columnTemperature > 60.f)
+			TreeDefinition::s_treeDefinitions[TREE_TYPE_WILLOW]->StampIntoChunk(chunkCoords, xIndex, yIndex, columnHeight, out_blockTypes, out_outsideWrites);
+		else if (columnTemperature > 40.f)
+			TreeDefinition::s_treeDefinitions[TREE_TYPE_OAK]->StampIntoChunk(chunkCoords, xIndex, yIndex, columnHeight, out_blockTypes, out_outsideWrites);
+		else
+			TreeDefinition::s_treeDefinitions[TREE_TYPE_PINE]->StampIntoChunk(chunkCoords, xIndex, yIndex, columnHeight, out_blockTypes, out_outsideWrites);
+	}
+}
+
+unsigned int TerrainGenerator::HashBlockTypes(const BlockType* blockTypes)
+{
+	//FNV-1a over the block types
+	unsigned int hash = 2166136261u;
+	for (int blockIndex = 0; blockIndex < BLOCKS_PER_CHUNK; ++blockIndex)
+	{
+		hash ^= (unsigned int)blockTypes[blockIndex];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void TerrainGenerator::FillColumnRun(BlockType* columnBlockTypes, int startZ, int endZ, BlockType blockType)
+{
+	for (int zIndex = startZ; zIndex < endZ; ++zIndex)
+	{
+		columnBlockTypes[zIndex * BLOCKS_PER_LAYER] = blockType;
+	}
+}
+
+int TerrainGenerator::FindTreeSites(const float* treeValues, int* out_siteColumnIndexes)
+{
+	//3x3 maximum as a pass along each row then a pass across rows, both plain loops over contiguous values the compiler can vectorize
+	const int numRows = GENERATION_COLUMNS_SIZE / GENERATION_COLUMNS_WIDTH;
+	float rowMaxima[GENERATION_COLUMNS_SIZE];
+	for (int rowIndex = 0; rowIndex < numRows; ++rowIndex)
+	{
+		const float* rowValues = treeValues + (rowIndex * GENERATION_COLUMNS_WIDTH);
+		float* rowMaximaValues = rowMaxima + (rowIndex * GENERATION_COLUMNS_WIDTH);
+		for (int xIndex = 1; xIndex < GENERATION_COLUMNS_WIDTH - 1; ++xIndex)
+		{
+			float leftOrCenter = (rowValues[xIndex - 1] > rowValues[xIndex]) ? rowValues[xIndex - 1] : rowValues[xIndex];
+			rowMaximaValues[xIndex] = (rowValues[xIndex + 1] > leftOrCenter) ? rowValues[xIndex + 1] : leftOrCenter;
+		}
+	}
+
+	float neighborhoodMaxima[GENERATION_COLUMNS_SIZE];
+	for (int rowIndex = 1; rowIndex < numRows - 1; ++rowIndex)
+	{
+		const float* southMaxima = rowMaxima + ((rowIndex - 1) * GENERATION_COLUMNS_WIDTH);
+		const float* centerMaxima = rowMaxima + (rowIndex * GENERATION_COLUMNS_WIDTH);
+		const float* northMaxima = rowMaxima + ((rowIndex + 1) * GENERATION_COLUMNS_WIDTH);
+		float* neighborhoodMaximaValues = neighborhoodMaxima + (rowIndex * GENERATION_COLUMNS_WIDTH);
+		for (int xIndex = 1; xIndex < GENERATION_COLUMNS_WIDTH - 1; ++xIndex)
+		{
+			float southOrCenter = (southMaxima[xIndex] > centerMaxima[xIndex]) ? southMaxima[xIndex] : centerMaxima[xIndex];
+			neighborhoodMaximaValues[xIndex] = (northMaxima[xIndex] > southOrCenter) ? northMaxima[xIndex] : southOrCenter;
+		}
+	}
+
+	//A site is a column nothing around it is higher than, listed column by column the order the trees have always been placed in
+	int numSites = 0;
+	for (int xIndex = 1; xIndex < GENERATION_COLUMNS_WIDTH - 1; ++xIndex)
+	{
+		for (int rowIndex = 1; rowIndex < numRows - 1; ++rowIndex)
+		{
+			int columnIndex = xIndex + (rowIndex * GENERATION_COLUMNS_WIDTH);
+			if (treeValues[columnIndex] >= neighborhoodMaxima[columnIndex])
+			{
+				out_siteColumnIndexes[numSites] = columnIndex;
+				++numSites;
+			}
+		}
+	}
+	return numSites;
+}
+
+bool TerrainGenerator::IsLocalMaxima(const float* arrayValues, int indexInArray, int numValues, int xDimension)
+{
+	float valueToCheck = arrayValues[indexInArray];
+
+	int northIndex = indexInArray + xDimension;
+	if (northIndex >= 0 && northIndex < numValues && valueToCheck < arrayValues[northIndex])
+	{
+		return false;
+	}
+
+	int northEastIndex = indexInArray + xDimension + 1;
+	if (northEastIndex >= 0 && northEastIndex < numValues && valueToCheck < arrayValues[northEastIndex])
+	{
+		return false;
+	}
+
+	int eastIndex = indexInArray + 1;
+	if (eastIndex >= 0 && eastIndex < numValues && valueToCheck < arrayValues[eastIndex])
+	{
+		return false;
+	}
+
+	int southEastIndex = indexInArray - xDimension + 1;
+	if (southEastIndex >= 0 && southEastIndex < numValues && valueToCheck < arrayValues[southEastIndex])
+	{
+		return false;
+	}
+
+	int southIndex = indexInArray - xDimension;
+	if (southIndex >= 0 && southIndex < numValues && valueToCheck < arrayValues[southIndex])
+	{
+		return false;
+	}
+
+	int southWestIndex = (indexInArray - xDimension) - 1;
+	if (southWestIndex >= 0 && southWestIndex < numValues && valueToCheck < arrayValues[southWestIndex])
+	{
+		return false;
+	}
+
+	int westIndex = indexInArray - 1;
+	if (westIndex >= 0 && westIndex < numValues && valueToCheck < arrayValues[westIndex])
+	{
+		return false;
+	}
+
+	int northWestIndex = indexInArray + xDimension - 1;
+	if (northWestIndex >= 0 && northWestIndex < numValues && valueToCheck < arrayValues[northWestIndex])
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+static void GenerateRegionChunks(const TerrainGenerator* generator, const std::vector<IntVector2>* chunkCoords, std::atomic<int>* nextChunkIndex, std::vector<BlockType>* out_blockTypes, std::vector<std::vector<DecorationWrite>>* out_outsideWrites)
+{
+	//Every worker fills its own column cache, the cache is not shared between threads
+	TerrainColumnCache columnCache(generator->GetNoiseSettings());
+	for (int chunkIndex = (*nextChunkIndex)++; chunkIndex < (int)chunkCoords->size(); chunkIndex = (*nextChunkIndex)++)
+	{
+		generator->GenerateChunk((*chunkCoords)[chunkIndex], columnCache, out_blockTypes->data() + (chunkIndex * BLOCKS_PER_CHUNK), (*out_outsideWrites)[chunkIndex]);
+	}
+}
+
+static void HashDecoratedChunks(const TerrainGenerator& generator, const std::vector<IntVector2>& regionChunkCoords, int numThreads, const std::vector<IntVector2>& hashedChunkCoords, std::vector<unsigned int>& out_hashes)
+{
+	std::vector<BlockType> regionBlockTypes(regionChunkCoords.size() * BLOCKS_PER_CHUNK);
+	std::vector<std::vector<DecorationWrite>> regionOutsideWrites(regionChunkCoords.size());
+	std::atomic<int> nextChunkIndex(0);
+	if (numThreads <= 1)
+	{
+		GenerateRegionChunks(&generator, &regionChunkCoords, &nextChunkIndex, &regionBlockTypes, &regionOutsideWrites);
+	}
+	else
+	{
+		std::vector<std::thread> workerThreads;
+		for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+		{
+			workerThreads.push_back(std::thread(GenerateRegionChunks, &generator, &regionChunkCoords, &nextChunkIndex, &regionBlockTypes, &regionOutsideWrites));
+		}
+		for (size_t threadIndex = 0; threadIndex < workerThreads.size(); ++threadIndex)
+		{
+			workerThreads[threadIndex].join();
+		}
+	}
+
+	//Each chunk's decorations land in its neighbors in the order the chunks were listed, writes past the region are dropped
+	std::map<IntVector2, int> regionChunkIndexes;
+	for (size_t chunkIndex = 0; chunkIndex < regionChunkCoords.size(); ++chunkIndex)
+	{
+		regionChunkIndexes[regionChunkCoords[chunkIndex]] = (int)chunkIndex;
+	}
+
+	for (size_t chunkIndex = 0; chunkIndex < regionChunkCoords.size(); ++chunkIndex)
+	{
+		const std::vector<DecorationWrite>& outsideWrites = regionOutsideWrites[chunkIndex];
+		for (size_t writeIndex = 0; writeIndex < outsideWrites.size(); ++writeIndex)
+		{
+			const DecorationWrite& write = outsideWrites[writeIndex];
+			std::map<IntVector2, int>::iterator found = regionChunkIndexes.find(write.m_chunkCoords);
+			if (found == regionChunkIndexes.end())
+				continue;
+
+			BlockType& blockType = regionBlockTypes[(found->second * BLOCKS_PER_CHUNK) + write.m_blockIndex];
+			if (CanDecorationReplace(blockType, write.m_blockType))
+				blockType = write.m_blockType;
+		}
+	}
+
+	out_hashes.resize(hashedChunkCoords.size());
+	for (size_t chunkIndex = 0; chunkIndex < hashedChunkCoords.size(); ++chunkIndex)
+	{
+		out_hashes[chunkIndex] = TerrainGenerator::HashBlockTypes(regionBlockTypes.data() + (regionChunkIndexes[hashedChunkCoords[chunkIndex]] * BLOCKS_PER_CHUNK));
+	}
+}
+
+static void GetGenerationCheckRegion(std::vector<IntVector2>& out_regionChunkCoords, std::vector<IntVector2>& out_checkedChunkCoords)
+{
+	//Always the chunks around the origin, so hashes from different builds of the same seed can be compared
+	//Checked chunks get every decoration that reaches them from a ring of chunks generated around them
+	for (int yOffset = (-GENERATION_CHECK_CHUNKS_PER_SIDE / 2) - GENERATION_CHECK_DECORATION_RING; yOffset < (GENERATION_CHECK_CHUNKS_PER_SIDE / 2) + GENERATION_CHECK_DECORATION_RING; ++yOffset)
+	{
+		for (int xOffset = (-GENERATION_CHECK_CHUNKS_PER_SIDE / 2) - GENERATION_CHECK_DECORATION_RING; xOffset < (GENERATION_CHECK_CHUNKS_PER_SIDE / 2) + GENERATION_CHECK_DECORATION_RING; ++xOffset)
+		{
+			IntVector2 offsetChunkCoords(xOffset, yOffset);
+			out_regionChunkCoords.push_back(offsetChunkCoords);
+
+			bool isInRing = xOffset < -GENERATION_CHECK_CHUNKS_PER_SIDE / 2 || xOffset >= GENERATION_CHECK_CHUNKS_PER_SIDE / 2 || yOffset < -GENERATION_CHECK_CHUNKS_PER_SIDE / 2 || yOffset >= GENERATION_CHECK_CHUNKS_PER_SIDE / 2;
+			if (!isInRing)
+				out_checkedChunkCoords.push_back(offsetChunkCoords);
+		}
+	}
+}
+
+TerrainNoiseSettings ChooseTerrainNoiseSettings(unsigned int worldSeed)
+{
+	//Batched noise is kept only if every sample matches; the coarse lattice is part of the terrain itself,
+	//chunks and far terrain both interpolate it, and saves from before it are regenerated
+	return TerrainNoiseSettings(worldSeed, IsBatchedTerrainNoiseExact(worldSeed), true);
+}
+
+GenerationDeterminismResult RunGenerationDeterminismCheck(const TerrainGenerator& generator)
+{
+	GenerationDeterminismResult result;
+
+	std::vector<IntVector2> regionChunkCoords;
+	std::vector<IntVector2> chunkCoords;
+	GetGenerationCheckRegion(regionChunkCoords, chunkCoords);
+	result.m_numChunks = (int)chunkCoords.size();
+
+	//Reference hashes come from generating the chunks in order on this thread
+	std::vector<unsigned int> referenceHashes;
+	HashDecoratedChunks(generator, regionChunkCoords, 1, chunkCoords, referenceHashes);
+
+	result.m_generationHash = 2166136261u;
+	for (size_t chunkIndex = 0; chunkIndex < referenceHashes.size(); ++chunkIndex)
+	{
+		result.m_generationHash = (result.m_generationHash ^ referenceHashes[chunkIndex]) * 16777619u;
+	}
+
+	//The same chunks in reverse order, so each one sees a differently filled column cache and decorations land the other way around
+	std::vector<IntVector2> reversedRegionChunkCoords(regionChunkCoords.rbegin(), regionChunkCoords.rend());
+	std::vector<unsigned int> reversedHashes;
+	HashDecoratedChunks(generator, reversedRegionChunkCoords, 1, chunkCoords, reversedHashes);
+	for (size_t chunkIndex = 0; chunkIndex < chunkCoords.size(); ++chunkIndex)
+	{
+		if (reversedHashes[chunkIndex] != referenceHashes[chunkIndex])
+			++result.m_numReverseOrderMismatches;
+	}
+
+	//And spread across worker threads, which take chunks in whatever order they get to them
+	result.m_numThreads = (int)std::thread::hardware_concurrency();
+	if (result.m_numThreads < 2)
+		result.m_numThreads = 2;
+
+	std::vector<unsigned int> threadedHashes;
+	HashDecoratedChunks(generator, regionChunkCoords, result.m_numThreads, chunkCoords, threadedHashes);
+	for (size_t chunkIndex = 0; chunkIndex < chunkCoords.size(); ++chunkIndex)
+	{
+		if (threadedHashes[chunkIndex] != referenceHashes[chunkIndex])
+			++result.m_numThreadedMismatches;
+	}
+
+	return result;
+}
+
+static int FindTreeSitesByLocalMaxima(const float* treeValues, int* out_siteColumnIndexes)
+{
+	//The way sites were found before the max filter, kept to measure against
+	int numSites = 0;
+	for (int xIndex = 0; xIndex < CHUNK_X; ++xIndex)
+	{
+		for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+		{
+			int columnIndex = (xIndex + GENERATION_COLUMN_PADDING) + ((yIndex + GENERATION_COLUMN_PADDING) * GENERATION_COLUMNS_WIDTH);
+			if (TerrainGenerator::IsLocalMaxima(treeValues, columnIndex, GENERATION_COLUMNS_SIZE, GENERATION_COLUMNS_WIDTH))
+			{
+				out_siteColumnIndexes[numSites] = columnIndex;
+				++numSites;
+			}
+		}
+	}
+	return numSites;
+}
+
+TreeSiteBenchmarkResult RunTreeSiteBenchmark(const TerrainGenerator& generator, const IntVector2& centerChunkCoords)
+{
+	//Finds the tree sites of the chunks around the center both ways, timing each and counting chunks where they disagree
+	TreeSiteBenchmarkResult result;
+	TerrainColumnCache columnCache(generator.GetNoiseSettings());
+	std::vector<float> treeValues(GENERATION_COLUMNS_SIZE * GENERATION_CHECK_CHUNKS_PER_SIDE * GENERATION_CHECK_CHUNKS_PER_SIDE);
+	TerrainColumn columns[GENERATION_COLUMNS_SIZE];
+	int numChunks = 0;
+	for (int yOffset = -GENERATION_CHECK_CHUNKS_PER_SIDE / 2; yOffset < GENERATION_CHECK_CHUNKS_PER_SIDE / 2; ++yOffset)
+	{
+		for (int xOffset = -GENERATION_CHECK_CHUNKS_PER_SIDE / 2; xOffset < GENERATION_CHECK_CHUNKS_PER_SIDE / 2; ++xOffset)
+		{
+			columnCache.GatherColumns(IntVector2(centerChunkCoords.x + xOffset, centerChunkCoords.y + yOffset), GENERATION_COLUMN_PADDING, columns);
+			for (int columnIndex = 0; columnIndex < GENERATION_COLUMNS_SIZE; ++columnIndex)
+			{
+				treeValues[(numChunks * GENERATION_COLUMNS_SIZE) + columnIndex] = columns[columnIndex].m_treeValue;
+			}
+			++numChunks;
+		}
+	}
+
+	int localMaximaSites[MAX_TREE_SITES];
+	int numLocalMaximaSites = 0;
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int repeatIndex = 0; repeatIndex < TREE_SITE_BENCHMARK_REPEATS; ++repeatIndex)
+	{
+		for (int chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+		{
+			numLocalMaximaSites = FindTreeSitesByLocalMaxima(treeValues.data() + (chunkIndex * GENERATION_COLUMNS_SIZE), localMaximaSites);
+		}
+	}
+	result.m_localMaximaSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	int filterSites[MAX_TREE_SITES];
+	int numFilterSites = 0;
+	startSeconds = GetCurrentTimeSeconds();
+	for (int repeatIndex = 0; repeatIndex < TREE_SITE_BENCHMARK_REPEATS; ++repeatIndex)
+	{
+		for (int chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+		{
+			numFilterSites = TerrainGenerator::FindTreeSites(treeValues.data() + (chunkIndex * GENERATION_COLUMNS_SIZE), filterSites);
+		}
+	}
+	result.m_maxFilterSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	//Timed loops only keep the last chunk's sites, so compare every chunk once more outside them
+	for (int chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+	{
+		const float* chunkTreeValues = treeValues.data() + (chunkIndex * GENERATION_COLUMNS_SIZE);
+		numFilterSites = TerrainGenerator::FindTreeSites(chunkTreeValues, filterSites);
+		result.m_numSites += numFilterSites;
+
+		numLocalMaximaSites = FindTreeSitesByLocalMaxima(chunkTreeValues, localMaximaSites);
+
+		bool doSitesMatch = (numFilterSites == numLocalMaximaSites);
+		for (int siteIndex = 0; doSitesMatch && siteIndex < numFilterSites; ++siteIndex)
+		{
+			doSitesMatch = (filterSites[siteIndex] == localMaximaSites[siteIndex]);
+		}
+		if (!doSitesMatch)
+			++result.m_numMismatches;
+	}
+
+	return result;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Game/TerrainColumnCache.hpp"
+#include "Game/TreeDefinition.hpp"
+#include "Engine/Math/IntVector2.hpp"
+
+
+constexpr int GENERATION_CHECK_CHUNKS_PER_SIDE = 4;
+constexpr int GENERATION_CHECK_DECORATION_RING = 1;		//chunks generated around the checked ones so their decorations reach in
+constexpr int GENERATION_COLUMN_PADDING = 1;		//tree sites compare against the columns around them
+constexpr int GENERATION_COLUMNS_WIDTH = CHUNK_X + (2 * GENERATION_COLUMN_PADDING);
+constexpr int GENERATION_COLUMNS_SIZE = GENERATION_COLUMNS_WIDTH * (CHUNK_Y + (2 * GENERATION_COLUMN_PADDING));
+constexpr int MAX_TREE_SITES = BLOCKS_PER_LAYER;
+constexpr int TREE_SITE_BENCHMARK_REPEATS = 16;
+
+
+struct GenerationDeterminismResult
+{
+	unsigned int m_generationHash;		//combined hash of every checked chunk, the same seed should always give the same value
+	int m_numChunks;
+	int m_numReverseOrderMismatches;
+	int m_numThreadedMismatches;
+	int m_numThreads;
+
+	GenerationDeterminismResult();
+};
+
+
+struct TreeSiteBenchmarkResult
+{
+	double m_localMaximaSeconds;		//checking every column's eight neighbors one by one
+	double m_maxFilterSeconds;
+	int m_numSites;
+	int m_numMismatches;
+
+	TreeSiteBenchmarkResult();
+};
+
+
+//Fills a chunk's blocks from the world seed and chunk coordinates alone, so chunks can be generated in any order or on any thread
+//Decorations rooted in the chunk that reach into its neighbors hand those blocks back as writes for the neighbors
+class TerrainGenerator
+{
+public:
+	explicit TerrainGenerator(const TerrainNoiseSettings& noiseSettings);
+
+	void GenerateChunk(const IntVector2& chunkCoords, TerrainColumnCache& columnCache, BlockType* out_blockTypes, std::vector<DecorationWrite>& out_outsideWrites, GenerationProfile* profile = nullptr) const;
+	const TerrainNoiseSettings& GetNoiseSettings() const;
+	unsigned int GetWorldSeed() const;
+
+	static unsigned int HashBlockTypes(const BlockType* blockTypes);
+	static int FindTreeSites(const float* treeValues, int* out_siteColumnIndexes);
+	static bool IsLocalMaxima(const float* arrayValues, int indexInArray, int numValues, int xDimension);
+
+private:
+	static void FillStrata(const TerrainColumn* columns, BlockType* out_blockTypes);
+	static void Decorate(const IntVector2& chunkCoords, const TerrainColumn* columns, BlockType* out_blockTypes, std::vector<DecorationWrite>& out_outsideWrites);
+	static void FillColumnRun(BlockType* columnBlockTypes, int startZ, int endZ, BlockType blockType);
+
+	TerrainNoiseSettings m_noiseSettings;
+};
+
+
+TerrainNoiseSettings ChooseTerrainNoiseSettings(unsigned int worldSeed);
+GenerationDeterminismResult RunGenerationDeterminismCheck(const TerrainGenerator& generator);
+TreeSiteBenchmarkResult RunTreeSiteBenchmark(const TerrainGenerator& generator, const IntVector2& centerChunkCoords);
+
+
+inline const TerrainNoiseSettings& TerrainGenerator::GetNoiseSettings() const
+{
+	return m_noiseSettings;
+}
+
+inline unsigned int TerrainGenerator::GetWorldSeed() const
+{
+	return m_noiseSettings.m_worldSeed;
+}
@@ -0,0 +1,372 @@
+#include "Game/TerrainNoise.hpp"
+#include "Game/TerrainColumnCache.hpp"
+#include "Engine/Core/Noise.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Time.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+
+static const float MOUNTAINOUSNESS_AMPLITUDE = 20.f;
+static const PerlinNoiseField TERRAIN_NOISE_FIELDS[NUM_TERRAIN_NOISE_FIELDS] =
+{
+	PerlinNoiseField(500.f, 5, 0.2f, 2.f, true, 35),		//mountainousness
+	PerlinNoiseField(60.f, 5, 0.4f),						//height
+	PerlinNoiseField(40.f, 4, 0.5f, 1.5f, true, 3534879),	//wetness
+	PerlinNoiseField(500.f, 5, 0.4f, 2.f, true, 543253),	//temperature
+	PerlinNoiseField(100.f, 5, 0.2f, 2.f, true, 1)			//trees, octave scale is the column's wetness
+};
+
+static const int NOISE_CHECK_ROWS = 32;
+static const int NOISE_CHECK_COLUMNS = 64;
+static const int NOISE_BENCHMARK_ROWS = 128;
+static const int NOISE_BENCHMARK_TILES_PER_SIDE = 4;
+
+
+TerrainNoiseSettings::TerrainNoiseSettings(unsigned int worldSeed, bool isBatchedNoiseEnabled, bool isCoarseNoiseEnabled)
+	: m_worldSeed(worldSeed)
+	, m_isBatchedNoiseEnabled(isBatchedNoiseEnabled && IsBatchedNoiseSupported())
+	, m_isCoarseNoiseEnabled(isCoarseNoiseEnabled)
+{
+
+}
+
+bool TerrainNoiseSettings::operator==(const TerrainNoiseSettings& other) const
+{
+	return m_worldSeed == other.m_worldSeed && m_isBatchedNoiseEnabled == other.m_isBatchedNoiseEnabled && m_isCoarseNoiseEnabled == other.m_isCoarseNoiseEnabled;
+}
+
+NoiseBenchmarkResult::NoiseBenchmarkResult()
+	: m_scalarSamplesPerSecond(0.0)
+	, m_batchedSamplesPerSecond(0.0)
+	, m_maxBatchedDeviation(0.f)
+	, m_isBatchedNoiseEnabled(false)
+	, m_fullTilesPerSecond(0.0)
+	, m_coarseTilesPerSecond(0.0)
+	, m_maxCoarseMountainousnessDeviation(0.f)
+	, m_maxCoarseTemperatureDeviation(0.f)
+	, m_maxCoarseColumnHeightDifference(0)
+	, m_isCoarseNoiseEnabled(false)
+{
+
+}
+
+PerlinNoiseField GetTerrainNoiseField(TerrainNoiseFieldType fieldType, unsigned int worldSeed)
+{
+	//Each field keeps its own base seed, the world seed shifts all of them so a seed of zero gives the original terrain
+	PerlinNoiseField field = TERRAIN_NOISE_FIELDS[fieldType];
+	field.m_seed += worldSeed;
+	return field;
+}
+
+float ComputeMountainousness(unsigned int worldSeed, float worldX, float worldY)
+{
+	PerlinNoiseField field = GetTerrainNoiseField(TERRAIN_NOISE_MOUNTAINOUSNESS, worldSeed);
+	return (MOUNTAINOUSNESS_AMPLITUDE * SampleNoiseField(field, worldX, worldY, field.m_octaveScale)) + MOUNTAINOUSNESS_AMPLITUDE;
+}
+
+int ComputeColumnHeight(unsigned int worldSeed, float worldX, float worldY, float mountainousness)
+{
+	PerlinNoiseField field = GetTerrainNoiseField(TERRAIN_NOISE_HEIGHT, worldSeed);
+	float columnHeight = (float)SEA_LEVEL;
+	columnHeight += mountainousness * SampleNoiseField(field, worldX, worldY, field.m_octaveScale);
+	return (int)columnHeight;
+}
+
+float ComputeWetness(unsigned int worldSeed, float worldX, float worldY)
+{
+	PerlinNoiseField field = GetTerrainNoiseField(TERRAIN_NOISE_WETNESS, worldSeed);
+	return RangeMapFloat(SampleNoiseField(field, worldX, worldY, field.m_octaveScale), -1.f, 1.f, 0.f, 2.f);
+}
+
+float ComputeTemperature(unsigned int worldSeed, float worldX, float worldY)
+{
+	PerlinNoiseField field = GetTerrainNoiseField(TERRAIN_NOISE_TEMPERATURE, worldSeed);
+	return RangeMapFloat(SampleNoiseField(field, worldX, worldY, field.m_octaveScale), -1.f, 1.f, 0.f, 100.f);
+}
+
+float ComputeTreeValue(unsigned int worldSeed, float worldX, float worldY, float wetness)
+{
+	return SampleNoiseField(GetTerrainNoiseField(TERRAIN_NOISE_TREES, worldSeed), worldX, worldY, wetness);
+}
+
+void ComputeMountainousnessRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, float* out_mountainousness, float spacing)
+{
+	Compute2dPerlinNoiseRow(GetTerrainNoiseField(TERRAIN_NOISE_MOUNTAINOUSNESS, settings.m_worldSeed), settings.m_isBatchedNoiseEnabled, startX, worldY, spacing, numColumns, out_mountainousness);
+	for (int columnIndex = 0; columnIndex < numColumns; ++columnIndex)
+	{
+		out_mountainousness[columnIndex] = (MOUNTAINOUSNESS_AMPLITUDE * out_mountainousness[columnIndex]) + MOUNTAINOUSNESS_AMPLITUDE;
+	}
+}
+
+void ComputeColumnHeightRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, const float* mountainousness, int* out_columnHeights)
+{
+	ASSERT_OR_DIE(numColumns <= CHUNK_X, "Column height rows are at most one chunk wide");
+
+	float heightNoise[CHUNK_X];
+	Compute2dPerlinNoiseRow(GetTerrainNoiseField(TERRAIN_NOISE_HEIGHT, settings.m_worldSeed), settings.m_isBatchedNoiseEnabled, startX, worldY, 1.f, numColumns, heightNoise);
+	for (int columnIndex = 0; columnIndex < numColumns; ++columnIndex)
+	{
+		float columnHeight = (float)SEA_LEVEL;
+		columnHeight += mountainousness[columnIndex] * heightNoise[columnIndex];
+		out_columnHeights[columnIndex] = (int)columnHeight;
+	}
+}
+
+void ComputeWetnessRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, float* out_wetness)
+{
+	Compute2dPerlinNoiseRow(GetTerrainNoiseField(TERRAIN_NOISE_WETNESS, settings.m_worldSeed), settings.m_isBatchedNoiseEnabled, startX, worldY, 1.f, numColumns, out_wetness);
+	for (int columnIndex = 0; columnIndex < numColumns; ++columnIndex)
+	{
+		out_wetness[columnIndex] = RangeMapFloat(out_wetness[columnIndex], -1.f, 1.f, 0.f, 2.f);
+	}
+}
+
+void ComputeTemperatureRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, float* out_temperatures, float spacing)
+{
+	Compute2dPerlinNoiseRow(GetTerrainNoiseField(TERRAIN_NOISE_TEMPERATURE, settings.m_worldSeed), settings.m_isBatchedNoiseEnabled, startX, worldY, spacing, numColumns, out_temperatures);
+	for (int columnIndex = 0; columnIndex < numColumns; ++columnIndex)
+	{
+		out_temperatures[columnIndex] = RangeMapFloat(out_temperatures[columnIndex], -1.f, 1.f, 0.f, 100.f);
+	}
+}
+
+void ComputeTreeValueRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, const float* wetness, float* out_treeValues)
+{
+	Compute2dPerlinNoiseRow(GetTerrainNoiseField(TERRAIN_NOISE_TREES, settings.m_worldSeed), settings.m_isBatchedNoiseEnabled, startX, worldY, 1.f, numColumns, out_treeValues, wetness);
+}
+
+static void ComputeLowFrequencyFieldRow(const TerrainNoiseSettings& settings, TerrainNoiseFieldType fieldType, float startX, float worldY, int numColumns, float* out_values, float spacing)
+{
+	if (fieldType == TERRAIN_NOISE_MOUNTAINOUSNESS)
+		ComputeMountainousnessRow(settings, startX, worldY, numColumns, out_values, spacing);
+	else
+		ComputeTemperatureRow(settings, startX, worldY, numColumns, out_values, spacing);
+}
+
+void ComputeLowFrequencyFieldTile(const TerrainNoiseSettings& settings, TerrainNoiseFieldType fieldType, float tileMinX, float tileMinY, float* out_values)
+{
+	ASSERT_OR_DIE(fieldType == TERRAIN_NOISE_MOUNTAINOUSNESS || fieldType == TERRAIN_NOISE_TEMPERATURE, "Only mountainousness and temperature are smooth enough to interpolate");
+
+	if (!settings.m_isCoarseNoiseEnabled)
+	{
+		for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+		{
+			ComputeLowFrequencyFieldRow(settings, fieldType, tileMinX, tileMinY + (float)yIndex, CHUNK_X, out_values + (yIndex * CHUNK_X), 1.f);
+		}
+		return;
+	}
+
+	//The lattice includes the far edge of the tile, which lands on the same world positions as the next tile's first samples
+	float latticeValues[COARSE_NOISE_SAMPLES_PER_SIDE][COARSE_NOISE_SAMPLES_PER_SIDE];
+	for (int latticeY = 0; latticeY < COARSE_NOISE_SAMPLES_PER_SIDE; ++latticeY)
+	{
+		ComputeLowFrequencyFieldRow(settings, fieldType, tileMinX, tileMinY + (float)(latticeY * COARSE_NOISE_SPACING), COARSE_NOISE_SAMPLES_PER_SIDE, latticeValues[latticeY], (float)COARSE_NOISE_SPACING);
+	}
+
+	const float invSpacing = 1.f / (float)COARSE_NOISE_SPACING;
+	for (int yIndex = 0; yIndex < CHUNK_Y; ++yIndex)
+	{
+		int latticeY = yIndex / COARSE_NOISE_SPACING;
+		float fractionY = (float)(yIndex - (latticeY * COARSE_NOISE_SPACING)) * invSpacing;
+		for (int xIndex = 0; xIndex < CHUNK_X; ++xIndex)
+		{
+			int latticeX = xIndex / COARSE_NOISE_SPACING;
+			float fractionX = (float)(xIndex - (latticeX * COARSE_NOISE_SPACING)) * invSpacing;
+
+			float southValue = latticeValues[latticeY][latticeX] + ((latticeValues[latticeY][latticeX + 1] - latticeValues[latticeY][latticeX]) * fractionX);
+			float northValue = latticeValues[latticeY + 1][latticeX] + ((latticeValues[latticeY + 1][latticeX + 1] - latticeValues[latticeY + 1][latticeX]) * fractionX);
+			out_values[xIndex + (yIndex * CHUNK_X)] = southValue + ((northValue - southValue) * fractionY);
+		}
+	}
+}
+
+static float SampleLowFrequencyField(unsigned int worldSeed, TerrainNoiseFieldType fieldType, float worldX, float worldY)
+{
+	if (fieldType == TERRAIN_NOISE_MOUNTAINOUSNESS)
+		return ComputeMountainousness(worldSeed, worldX, worldY);
+	return ComputeTemperature(worldSeed, worldX, worldY);
+}
+
+float ComputeLowFrequencyFieldValue(const TerrainNoiseSettings& settings, TerrainNoiseFieldType fieldType, float worldX, float worldY)
+{
+	ASSERT_OR_DIE(fieldType == TERRAIN_NOISE_MOUNTAINOUSNESS || fieldType == TERRAIN_NOISE_TEMPERATURE, "Only mountainousness and temperature are smooth enough to interpolate");
+
+	if (!settings.m_isCoarseNoiseEnabled)
+		return SampleLowFrequencyField(settings.m_worldSeed, fieldType, worldX, worldY);
+
+	//Chunk mins fall on the lattice, so this is the same lattice and blend ComputeLowFrequencyFieldTile uses for the column
+	int blockX = (int)floorf(worldX);
+	int blockY = (int)floorf(worldY);
+	int latticeOffsetX = ((blockX % COARSE_NOISE_SPACING) + COARSE_NOISE_SPACING) % COARSE_NOISE_SPACING;
+	int latticeOffsetY = ((blockY % COARSE_NOISE_SPACING) + COARSE_NOISE_SPACING) % COARSE_NOISE_SPACING;
+	float latticeMinX = (float)(blockX - latticeOffsetX);
+	float latticeMinY = (float)(blockY - latticeOffsetY);
+	float latticeMaxX = latticeMinX + (float)COARSE_NOISE_SPACING;
+	float latticeMaxY = latticeMinY + (float)COARSE_NOISE_SPACING;
+
+	float southWestValue = SampleLowFrequencyField(settings.m_worldSeed, fieldType, latticeMinX, latticeMinY);
+	float southEastValue = SampleLowFrequencyField(settings.m_worldSeed, fieldType, latticeMaxX, latticeMinY);
+	float northWestValue = SampleLowFrequencyField(settings.m_worldSeed, fieldType, latticeMinX, latticeMaxY);
+	float northEastValue = SampleLowFrequencyField(settings.m_worldSeed, fieldType, latticeMaxX, latticeMaxY);
+
+	const float invSpacing = 1.f / (float)COARSE_NOISE_SPACING;
+	float fractionX = (float)latticeOffsetX * invSpacing;
+	float fractionY = (float)latticeOffsetY * invSpacing;
+	float southValue = southWestValue + ((southEastValue - southWestValue) * fractionX);
+	float northValue = northWestValue + ((northEastValue - northWestValue) * fractionX);
+	return southValue + ((northValue - southValue) * fractionY);
+}
+
+static int CountBatchedNoiseMismatches(unsigned int worldSeed)
+{
+	//Compare every field over a patch straddling the origin, so negative cells are checked too
+	float octaveScales[NOISE_CHECK_COLUMNS];
+	float batchedValues[NOISE_CHECK_COLUMNS];
+	int numMismatches = 0;
+	for (int fieldIndex = 0; fieldIndex < NUM_TERRAIN_NOISE_FIELDS; ++fieldIndex)
+	{
+		PerlinNoiseField field = GetTerrainNoiseField((TerrainNoiseFieldType)fieldIndex, worldSeed);
+		for (int rowIndex = 0; rowIndex < NOISE_CHECK_ROWS; ++rowIndex)
+		{
+			float startX = (float)(-NOISE_CHECK_COLUMNS / 2);
+			float worldY = (float)((rowIndex - (NOISE_CHECK_ROWS / 2)) * 37);
+			for (int columnIndex = 0; columnIndex < NOISE_CHECK_COLUMNS; ++columnIndex)
+			{
+				octaveScales[columnIndex] = (fieldIndex == TERRAIN_NOISE_TREES) ? ComputeWetness(worldSeed, startX + (float)columnIndex, worldY) : field.m_octaveScale;
+			}
+
+			Compute2dPerlinNoiseRow(field, true, startX, worldY, 1.f, NOISE_CHECK_COLUMNS, batchedValues, octaveScales);
+			for (int columnIndex = 0; columnIndex < NOISE_CHECK_COLUMNS; ++columnIndex)
+			{
+				if (batchedValues[columnIndex] != SampleNoiseField(field, startX + (float)columnIndex, worldY, octaveScales[columnIndex]))
+					++numMismatches;
+			}
+		}
+	}
+	return numMismatches;
+}
+
+bool IsBatchedTerrainNoiseExact(unsigned int worldSeed)
+{
+	//The batched path mirrors the engine's noise, only use it if every sample is bit for bit the same,
+	//since any difference can move a column height across a whole block and change saved chunks
+	return IsBatchedNoiseSupported() && CountBatchedNoiseMismatches(worldSeed) == 0;
+}
+
+static double TimeTerrainNoiseRows(const TerrainNoiseSettings& settings, float* out_values)
+{
+	float wetness[CHUNK_X];
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int rowIndex = 0; rowIndex < NOISE_BENCHMARK_ROWS; ++rowIndex)
+	{
+		float worldY = (float)rowIndex;
+		float* rowValues = out_values + (rowIndex * CHUNK_X * NUM_TERRAIN_NOISE_FIELDS);
+		ComputeMountainousnessRow(settings, 0.f, worldY, CHUNK_X, rowValues);
+		ComputeWetnessRow(settings, 0.f, worldY, CHUNK_X, wetness);
+		ComputeTemperatureRow(settings, 0.f, worldY, CHUNK_X, rowValues + CHUNK_X);
+		ComputeTreeValueRow(settings, 0.f, worldY, CHUNK_X, wetness, rowValues + (2 * CHUNK_X));
+		Compute2dPerlinNoiseRow(GetTerrainNoiseField(TERRAIN_NOISE_HEIGHT, settings.m_worldSeed), settings.m_isBatchedNoiseEnabled, 0.f, worldY, 1.f, CHUNK_X, rowValues + (3 * CHUNK_X));
+		for (int columnIndex = 0; columnIndex < CHUNK_X; ++columnIndex)
+		{
+			rowValues[(4 * CHUNK_X) + columnIndex] = wetness[columnIndex];
+		}
+	}
+	return GetCurrentTimeSeconds() - startSeconds;
+}
+
+static double TimeTerrainColumnTiles(const TerrainNoiseSettings& settings, TerrainColumnTile* out_tiles)
+{
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int tileY = 0; tileY < NOISE_BENCHMARK_TILES_PER_SIDE; ++tileY)
+	{
+		for (int tileX = 0; tileX < NOISE_BENCHMARK_TILES_PER_SIDE; ++tileX)
+		{
+			TerrainColumnCache::ComputeTile(settings, IntVector2(tileX, tileY), out_tiles[tileX + (tileY * NOISE_BENCHMARK_TILES_PER_SIDE)]);
+		}
+	}
+	return GetCurrentTimeSeconds() - startSeconds;
+}
+
+static void MeasureCoarseNoise(const TerrainNoiseSettings& settings, NoiseBenchmarkResult& out_result)
+{
+	//Generates the same tiles with every column sampled and with the coarse lattice, then compares the columns
+	TerrainNoiseSettings fullSettings = settings;
+	fullSettings.m_isCoarseNoiseEnabled = false;
+	TerrainNoiseSettings coarseSettings = settings;
+	coarseSettings.m_isCoarseNoiseEnabled = true;
+	double numTiles = (double)(NOISE_BENCHMARK_TILES_PER_SIDE * NOISE_BENCHMARK_TILES_PER_SIDE);
+	std::vector<TerrainColumnTile> fullTiles(NOISE_BENCHMARK_TILES_PER_SIDE * NOISE_BENCHMARK_TILES_PER_SIDE);
+	std::vector<TerrainColumnTile> coarseTiles(NOISE_BENCHMARK_TILES_PER_SIDE * NOISE_BENCHMARK_TILES_PER_SIDE);
+
+	double fullSeconds = TimeTerrainColumnTiles(fullSettings, fullTiles.data());
+	double coarseSeconds = TimeTerrainColumnTiles(coarseSettings, coarseTiles.data());
+
+	for (size_t tileIndex = 0; tileIndex < fullTiles.size(); ++tileIndex)
+	{
+		for (int columnIndex = 0; columnIndex < BLOCKS_PER_LAYER; ++columnIndex)
+		{
+			const TerrainColumn& fullColumn = fullTiles[tileIndex].m_columns[columnIndex];
+			const TerrainColumn& coarseColumn = coarseTiles[tileIndex].m_columns[columnIndex];
+
+			float mountainousnessDeviation = fabsf(coarseColumn.m_mountainousness - fullColumn.m_mountainousness);
+			float temperatureDeviation = fabsf(coarseColumn.m_temperature - fullColumn.m_temperature);
+			int columnHeightDifference = abs(coarseColumn.m_columnHeight - fullColumn.m_columnHeight);
+			if (mountainousnessDeviation > out_result.m_maxCoarseMountainousnessDeviation)
+				out_result.m_maxCoarseMountainousnessDeviation = mountainousnessDeviation;
+			if (temperatureDeviation > out_result.m_maxCoarseTemperatureDeviation)
+				out_result.m_maxCoarseTemperatureDeviation = temperatureDeviation;
+			if (columnHeightDifference > out_result.m_maxCoarseColumnHeightDifference)
+				out_result.m_maxCoarseColumnHeightDifference = columnHeightDifference;
+		}
+	}
+
+	out_result.m_fullTilesPerSecond = (fullSeconds > 0.0) ? numTiles / fullSeconds : 0.0;
+	out_result.m_coarseTilesPerSecond = (coarseSeconds > 0.0) ? numTiles / coarseSeconds : 0.0;
+	out_result.m_isCoarseNoiseEnabled = settings.m_isCoarseNoiseEnabled;
+}
+
+NoiseBenchmarkResult RunTerrainNoiseBenchmark(const TerrainNoiseSettings& settings)
+{
+	//Times all five fields over chunk-wide rows, one sample at a time and then batched
+	NoiseBenchmarkResult result;
+	TerrainNoiseSettings scalarSettings = settings;
+	scalarSettings.m_isBatchedNoiseEnabled = false;
+	TerrainNoiseSettings batchedSettings = settings;
+	batchedSettings.m_isBatchedNoiseEnabled = IsBatchedNoiseSupported();
+	double numSamples = (double)(NOISE_BENCHMARK_ROWS * CHUNK_X * NUM_TERRAIN_NOISE_FIELDS);
+	std::vector<float> scalarValues(NOISE_BENCHMARK_ROWS * CHUNK_X * NUM_TERRAIN_NOISE_FIELDS);
+	std::vector<float> batchedValues(NOISE_BENCHMARK_ROWS * CHUNK_X * NUM_TERRAIN_NOISE_FIELDS);
+
+	double scalarSeconds = TimeTerrainNoiseRows(scalarSettings, scalarValues.data());
+	double batchedSeconds = TimeTerrainNoiseRows(batchedSettings, batchedValues.data());
+
+	for (size_t valueIndex = 0; valueIndex < scalarValues.size(); ++valueIndex)
+	{
+		float deviation = fabsf(batchedValues[valueIndex] - scalarValues[valueIndex]);
+		if (deviation > result.m_maxBatchedDeviation)
+			result.m_maxBatchedDeviation = deviation;
+	}
+
+	result.m_scalarSamplesPerSecond = (scalarSeconds > 0.0) ? numSamples / scalarSeconds : 0.0;
+	result.m_batchedSamplesPerSecond = (batchedSeconds > 0.0) ? numSamples / batchedSeconds : 0.0;
+	result.m_isBatchedNoiseEnabled = settings.m_isBatchedNoiseEnabled;
+
+	MeasureCoarseNoise(settings, result);
+	return result;
+}
+
+bool IsDesert(float wetness, float temperature)
+{
+	return wetness < DESERT_WETNESS_MAXIMUM && temperature > DESERT_TEMPERATURE_MINIMUM;
+}
+
+BlockType GetSurfaceBlockType(int surfaceZ, float wetness, float temperature)
+{
+	if (surfaceZ <= SEA_LEVEL || IsDesert(wetness, temperature))
+		return BLOCK_TYPE_SAND;
+	if (temperature < SNOW_TEMPERATURE_MAXIMUM)
+		return BLOCK_TYPE_SNOW;
+	return BLOCK_TYPE_GRASS;
+}
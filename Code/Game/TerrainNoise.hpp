@@ -0,0 +1,77 @@
+#pragma once
+#include "Game/BlockDefinition.hpp"
+#include "Game/BatchNoise.hpp"
+
+
+constexpr int COARSE_NOISE_SPACING = 4;		//low frequency fields are sampled every fourth column and interpolated between
+constexpr int COARSE_NOISE_SAMPLES_PER_SIDE = (CHUNK_X / COARSE_NOISE_SPACING) + 1;
+
+
+enum TerrainNoiseFieldType
+{
+	TERRAIN_NOISE_MOUNTAINOUSNESS,
+	TERRAIN_NOISE_HEIGHT,
+	TERRAIN_NOISE_WETNESS,
+	TERRAIN_NOISE_TEMPERATURE,
+	TERRAIN_NOISE_TREES,
+	NUM_TERRAIN_NOISE_FIELDS
+};
+
+
+//The world seed plus how its fields are sampled: batched only when it matches one at a time, coarse for the low frequency fields
+struct TerrainNoiseSettings
+{
+	unsigned int m_worldSeed;
+	bool m_isBatchedNoiseEnabled;
+	bool m_isCoarseNoiseEnabled;
+
+	explicit TerrainNoiseSettings(unsigned int worldSeed = 0, bool isBatchedNoiseEnabled = false, bool isCoarseNoiseEnabled = false);
+
+	bool operator==(const TerrainNoiseSettings& other) const;
+};
+
+
+struct NoiseBenchmarkResult
+{
+	double m_scalarSamplesPerSecond;
+	double m_batchedSamplesPerSecond;
+	float m_maxBatchedDeviation;		//largest difference between the batched and one at a time noise at the same positions
+	bool m_isBatchedNoiseEnabled;
+
+	double m_fullTilesPerSecond;
+	double m_coarseTilesPerSecond;
+	float m_maxCoarseMountainousnessDeviation;		//largest differences between interpolated and fully sampled columns
+	float m_maxCoarseTemperatureDeviation;
+	int m_maxCoarseColumnHeightDifference;
+	bool m_isCoarseNoiseEnabled;
+
+	NoiseBenchmarkResult();
+};
+
+
+PerlinNoiseField GetTerrainNoiseField(TerrainNoiseFieldType fieldType, unsigned int worldSeed);
+
+//Noise fields shared by chunk generation and the far terrain, sampled at world block coordinates for a world seed
+float ComputeMountainousness(unsigned int worldSeed, float worldX, float worldY);
+int ComputeColumnHeight(unsigned int worldSeed, float worldX, float worldY, float mountainousness);
+float ComputeWetness(unsigned int worldSeed, float worldX, float worldY);
+float ComputeTemperature(unsigned int worldSeed, float worldX, float worldY);
+float ComputeTreeValue(unsigned int worldSeed, float worldX, float worldY, float wetness);
+
+//The same fields for a row of adjacent columns starting at startX
+void ComputeMountainousnessRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, float* out_mountainousness, float spacing = 1.f);
+void ComputeColumnHeightRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, const float* mountainousness, int* out_columnHeights);
+void ComputeWetnessRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, float* out_wetness);
+void ComputeTemperatureRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, float* out_temperatures, float spacing = 1.f);
+void ComputeTreeValueRow(const TerrainNoiseSettings& settings, float startX, float worldY, int numColumns, const float* wetness, float* out_treeValues);
+
+//Mountainousness or temperature for every column of the chunk starting at the tile mins, coarsely sampled when the settings allow it
+void ComputeLowFrequencyFieldTile(const TerrainNoiseSettings& settings, TerrainNoiseFieldType fieldType, float tileMinX, float tileMinY, float* out_values);
+//The same value for a single column, for the far terrain
+float ComputeLowFrequencyFieldValue(const TerrainNoiseSettings& settings, TerrainNoiseFieldType fieldType, float worldX, float worldY);
+
+bool IsBatchedTerrainNoiseExact(unsigned int worldSeed);
+NoiseBenchmarkResult RunTerrainNoiseBenchmark(const TerrainNoiseSettings& settings);
+
+bool IsDesert(float wetness, float temperature);
+BlockType GetSurfaceBlockType(int surfaceZ, float wetness, float temperature);
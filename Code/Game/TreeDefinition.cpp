@@ -1,10 +1,75 @@
 #include "Game/TreeDefinition.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
 
 TreeDefinition* TreeDefinition::s_treeDefinitions[];
 
 TreeDefinition::TreeDefinition(const std::vector<TreeBlockDefinition>& treeBlocks)
 	: m_treeBlocks(treeBlocks)
+	, m_offsetMins(0, 0, 0)
+	, m_offsetMaxs(0, 0, 0)
+	, m_blockIndexOffsets()
+	, m_blockTypes()
 {
+	m_blockIndexOffsets.reserve(treeBlocks.size());
+	m_blockTypes.reserve(treeBlocks.size());
+	for (size_t treeBlockIndex = 0; treeBlockIndex < treeBlocks.size(); ++treeBlockIndex)
+	{
+		const IntVector3& offset = treeBlocks[treeBlockIndex].offsetFromBase;
+		if (treeBlockIndex == 0)
+		{
+			m_offsetMins = offset;
+			m_offsetMaxs = offset;
+		}
 
+		m_offsetMins = IntVector3(offset.x < m_offsetMins.x ? offset.x : m_offsetMins.x, offset.y < m_offsetMins.y ? offset.y : m_offsetMins.y, offset.z < m_offsetMins.z ? offset.z : m_offsetMins.z);
+		m_offsetMaxs = IntVector3(offset.x > m_offsetMaxs.x ? offset.x : m_offsetMaxs.x, offset.y > m_offsetMaxs.y ? offset.y : m_offsetMaxs.y, offset.z > m_offsetMaxs.z ? offset.z : m_offsetMaxs.z);
+
+		m_blockIndexOffsets.push_back(offset.x + (offset.y * CHUNK_X) + (offset.z * BLOCKS_PER_LAYER));
+		ASSERT_OR_DIE(GetDecorationPriority(treeBlocks[treeBlockIndex].blockType) > 0, "Tree blocks need a decoration priority above air");
+		m_blockTypes.push_back(treeBlocks[treeBlockIndex].blockType);
+	}
 }
 
+void TreeDefinition::StampIntoChunk(const IntVector2& chunkCoords, int baseX, int baseY, int baseZ, BlockType* out_blockTypes, std::vector<DecorationWrite>& out_outsideWrites) const
+{
+	//Base coordinates are relative to the chunk, and trees only grow into air or lower priority tree blocks
+	if (baseZ + m_offsetMaxs.z < 0 || baseZ + m_offsetMins.z >= CHUNK_Z)
+		return;
+
+	bool isInsideChunk = baseX + m_offsetMins.x >= 0 && baseX + m_offsetMaxs.x < CHUNK_X && baseY + m_offsetMins.y >= 0 && baseY + m_offsetMaxs.y < CHUNK_Y && baseZ + m_offsetMins.z >= 0 && baseZ + m_offsetMaxs.z < CHUNK_Z;
+	if (isInsideChunk)
+	{
+		BlockType* baseBlockType = out_blockTypes + baseX + (baseY * CHUNK_X) + (baseZ * BLOCKS_PER_LAYER);
+		for (size_t treeBlockIndex = 0; treeBlockIndex < m_blockTypes.size(); ++treeBlockIndex)
+		{
+			BlockType& blockType = baseBlockType[m_blockIndexOffsets[treeBlockIndex]];
+			if (CanDecorationReplace(blockType, m_blockTypes[treeBlockIndex]))
+				blockType = m_blockTypes[treeBlockIndex];
+		}
+		return;
+	}
+
+	//Trees straddling the chunk border hand the blocks past it to whichever chunk they land in
+	for (size_t treeBlockIndex = 0; treeBlockIndex < m_treeBlocks.size(); ++treeBlockIndex)
+	{
+		const IntVector3& offset = m_treeBlocks[treeBlockIndex].offsetFromBase;
+		int xIndex = baseX + offset.x;
+		int yIndex = baseY + offset.y;
+		int zIndex = baseZ + offset.z;
+		if (zIndex < 0 || zIndex >= CHUNK_Z)
+			continue;
+
+		if (xIndex < 0 || xIndex >= CHUNK_X || yIndex < 0 || yIndex >= CHUNK_Y)
+		{
+			int chunkOffsetX = (xIndex < 0) ? (((xIndex + 1) / CHUNK_X) - 1) : (xIndex / CHUNK_X);
+			int chunkOffsetY = (yIndex < 0) ? (((yIndex + 1) / CHUNK_Y) - 1) : (yIndex / CHUNK_Y);
+			int localBlockIndex = (xIndex & (CHUNK_X - 1)) + ((yIndex & (CHUNK_Y - 1)) * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER);
+			out_outsideWrites.push_back(DecorationWrite(IntVector2(chunkCoords.x + chunkOffsetX, chunkCoords.y + chunkOffsetY), localBlockIndex, m_blockTypes[treeBlockIndex]));
+			continue;
+		}
+
+		BlockType& blockType = out_blockTypes[xIndex + (yIndex * CHUNK_X) + (zIndex * BLOCKS_PER_LAYER)];
+		if (CanDecorationReplace(blockType, m_blockTypes[treeBlockIndex]))
+			blockType = m_blockTypes[treeBlockIndex];
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "Engine\Math\IntVector3.hpp"
 #include "BlockDefinition.hpp"
+#include "Game/DecorationWriteStore.hpp"
 #include <vector>
 
 
@@ -30,6 +31,12 @@ class TreeDefinition
 private:
 	std::vector<TreeBlockDefinition> m_treeBlocks;
 
+	//Compiled once so stamping a tree into a chunk needs no allocations or lookups
+	IntVector3 m_offsetMins;
+	IntVector3 m_offsetMaxs;
+	std::vector<int> m_blockIndexOffsets;		//offsets from the base as chunk block index deltas, valid when the whole tree fits in the chunk
+	std::vector<BlockType> m_blockTypes;
+
 
 public:
 	static TreeDefinition* s_treeDefinitions[NUM_TREE_TYPES];
@@ -38,12 +45,13 @@ public:
 
 	TreeDefinition(const std::vector<TreeBlockDefinition>& treeBlocks);
 
-	const std::vector<TreeBlockDefinition> GetTreeBlocks() const;
+	const std::vector<TreeBlockDefinition>& GetTreeBlocks() const;
+	void StampIntoChunk(const IntVector2& chunkCoords, int baseX, int baseY, int baseZ, BlockType* out_blockTypes, std::vector<DecorationWrite>& out_outsideWrites) const;
 };
 
 
 
-inline const std::vector<TreeBlockDefinition> TreeDefinition::GetTreeBlocks() const
+inline const std::vector<TreeBlockDefinition>& TreeDefinition::GetTreeBlocks() const
 {
 	return m_treeBlocks;
 }
@@ -1,37 +1,216 @@
 #include "Game/World.hpp"
 #include <math.h>
+#include <limits.h>
+#include <stdlib.h>
 #include "Engine/Core/ProfileLogScope.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+
+
+LightingWorkStats::LightingWorkStats()
+	: m_numBlocksDirtied(0)
+	, m_numRemovalVisits(0)
+	, m_numAddVisits(0)
+	, m_numLightChanges(0)
+	, m_peakQueueDepth(0)
+	, m_numEntriesCarriedOver(0)
+	, m_numChunkRebuildsDeferred(0)
+	, m_seconds(0.0)
+{
+
+}
+
+
+WorldRenderStats::WorldRenderStats()
+	: m_numChunksDrawn(0)
+	, m_numChunksInFrustum(0)
+	, m_numCullingTests(0)
+	, m_numRendererCalls(0)
+	, m_numDrawCalls(0)
+	, m_numVertexesDrawn(0)
+	, m_numOutOfOrderVertexes(0)
+	, m_wasDrawListRebuilt(false)
+	, m_visibilitySeconds(0.0)
+	, m_submissionSeconds(0.0)
+{
+
+}
+
+
+DrawOrderBenchmarkResult::DrawOrderBenchmarkResult()
+	: m_numChunks(0)
+	, m_numVertexes(0)
+	, m_numUnsortedOutOfOrderVertexes(0)
+	, m_numSortedOutOfOrderVertexes(0)
+	, m_unsortedRebuildSeconds(0.0)
+	, m_sortedRebuildSeconds(0.0)
+	, m_unsortedSubmissionSeconds(0.0)
+	, m_sortedSubmissionSeconds(0.0)
+{
+
+}
+
+
+static float CalcDistanceSquaredToChunkXY(const Vector3& cameraPosition, const Chunk* chunk)
+{
+	return CalcDistanceSquared(Vector2(cameraPosition.x, cameraPosition.y), Vector2(chunk->GetChunkCenter().x, chunk->GetChunkCenter().y));
+}
+
+static void SortChunksFrontToBack(const Vector3& cameraPosition, std::vector<Chunk*>& chunks)
+{
+	std::sort(chunks.begin(), chunks.end(), [&cameraPosition](Chunk* lhs, Chunk* rhs)
+	{
+		return CalcDistanceSquaredToChunkXY(cameraPosition, lhs) < CalcDistanceSquaredToChunkXY(cameraPosition, rhs);
+	});
+}
+
+static int CountOutOfOrderVertexes(const Vector3& cameraPosition, const std::vector<Chunk*>& drawnChunks, const std::vector<RecordedDraw>& draws)
+{
+	//Vertexes of every recorded draw that came after a draw further from the camera, where early depth testing can't help
+	std::map<unsigned int, float> distanceSquaredByVBO;
+	for (size_t chunkIndex = 0; chunkIndex < drawnChunks.size(); ++chunkIndex)
+	{
+		distanceSquaredByVBO[drawnChunks[chunkIndex]->GetVBOID()] = CalcDistanceSquaredToChunkXY(cameraPosition, drawnChunks[chunkIndex]);
+	}
+
+	int numOutOfOrderVertexes = 0;
+	float furthestDistanceSquaredDrawn = 0.f;
+	for (size_t drawIndex = 0; drawIndex < draws.size(); ++drawIndex)
+	{
+		float distanceSquared = distanceSquaredByVBO[draws[drawIndex].m_vboID];
+		if (distanceSquared < furthestDistanceSquaredDrawn)
+			numOutOfOrderVertexes += draws[drawIndex].m_numVertexes;
+		else
+			furthestDistanceSquaredDrawn = distanceSquared;
+	}
+	return numOutOfOrderVertexes;
+}
 
 
 World::World()
-	: m_numCurrentChunks(0)
+	: m_chunks()
+	, m_chunkTree()
+	, m_terrainGenerator(ChooseTerrainNoiseSettings(WORLD_SEED))
+	, m_terrainColumnCache(m_terrainGenerator.GetNoiseSettings())
+	, m_numCurrentChunks(0)
+	, m_renderFrameNumber(0)
+	, m_renderStats()
+	, m_isOcclusionCullingEnabled(true)
+	, m_isDrawListCachingEnabled(true)
+	, m_isDrawListDirty(true)
+	, m_drawList()
+	, m_drawListCameraChunkCoords(0, 0)
+	, m_drawListCameraSectionIndex(0)
+	, m_drawListCameraForward(Vector3::ZERO)
+	, m_hasDrawOrderBenchmarkResult(false)
+	, m_drawOrderBenchmarkResult()
+	, m_areLevelsOfDetailEnabled(true)
+	, m_farTerrain(m_terrainGenerator.GetNoiseSettings())
+	, m_isFarTerrainEnabled(true)
+	, m_isDayNightCycleEnabled(false)
+	, m_timeOfDay(0.f)
+	, m_skyLightLevel(SKY_LIGHT_VALUE)
+	, m_dirtyLightingQueue()
+	, m_lightRemovalQueue()
+	, m_lightAddQueue()
+	, m_farLightAddQueue()
+	, m_lightingSlots()
+	, m_numPendingEntriesInSlot()
+	, m_freeLightingSlots()
+	, m_lightingFocusChunkCoords(0, 0)
+	, m_lightingVisitBudget(LIGHTING_VISITS_PER_FRAME)
+	, m_numActivationLightEntries(0)
+	, m_numLightingActivations(0)
+	, m_activationSeconds(0.0)
+	, m_lightingInitializationSeconds(0.0)
+	, m_isParallelLightingEnabled(false)
+	, m_lightingJobs()
+	, m_scheduledLightingJobs()
+	, m_lightingWorkerPool()
+	, m_hasLightingDeterminismResult(false)
+	, m_numLightingDeterminismMismatches(0)
+	, m_lightingStats()
+	, m_hasLightingBenchmarkResults(false)
+	, m_hasNoiseBenchmarkResult(false)
+	, m_noiseBenchmarkResult()
+	, m_hasGenerationDeterminismResult(false)
+	, m_generationDeterminismResult()
+	, m_treeSiteBenchmarkResult()
+	, m_generationProfile()
+	, m_decorationWriteStore()
 {
-	
+	for (int lodLevel = 0; lodLevel < NUM_LOD_LEVELS; ++lodLevel)
+	{
+		m_numChunksAtLodLevel[lodLevel] = 0;
+	}
 }
 
-void World::Update(float deltaSeconds, const Vector3& playerPosition)
+void World::Update(float deltaSeconds, const Vector3& playerPosition, const Vector3& cameraPosition)
 {
 	ManageChunks(playerPosition);
 	UpdateChunks(deltaSeconds);
-	UpdateLighting();
+
+	//Lighting near what is on screen settles first, even when the camera is detached from the player
+	m_lightingFocusChunkCoords = GetChunkCoordsFromWorldCoords(cameraPosition);
+	UpdateLighting(m_lightingVisitBudget);
+	UpdateSkyLightLevel(deltaSeconds);
+	UpdateLevelsOfDetail(playerPosition);
 	UpdateVertexArrays();
+
+	if (m_isFarTerrainEnabled)
+	{
+		m_farTerrain.Update(playerPosition);
+	}
 }
 
 void World::Render(const Vector3& cameraPosition, const Vector3& cameraForward) const
 {
-	std::map<ChunkCoords, Chunk*>::const_iterator chunkIter = m_chunks.begin();
-	for (chunkIter; chunkIter != m_chunks.end(); chunkIter++)
+	double visibilityStartSeconds = GetCurrentTimeSeconds();
+
+	m_renderStats.m_wasDrawListRebuilt = false;
+	if (!m_isDrawListCachingEnabled || m_isDrawListDirty || ShouldRebuildDrawList(cameraPosition, cameraForward))
 	{
-		if(CanPlayerSeeChunk(cameraPosition, cameraForward, chunkIter->second))
-		{
-			chunkIter->second->Render();
-		}
+		RebuildDrawList(cameraPosition, cameraForward);
+	}
+
+	double submissionStartSeconds = GetCurrentTimeSeconds();
+
+	//Every chunk call goes through the recorder, so the counts below are the calls actually made
+	RecordingRenderer chunkRenderer(g_theRenderer);
+	for (size_t drawIndex = 0; drawIndex < m_drawList.size(); ++drawIndex)
+	{
+		m_drawList[drawIndex]->Render(chunkRenderer);
+	}
+
+	if (!m_drawList.empty())
+	{
+		chunkRenderer.BindBuffer(0);
+	}
+
+	//Drawn after the chunks so the depth test rejects whatever they already cover
+	if (m_isFarTerrainEnabled)
+	{
+		m_farTerrain.Render(cameraPosition, cameraForward);
 	}
+
+	double submissionEndSeconds = GetCurrentTimeSeconds();
+
+	m_renderStats.m_numChunksDrawn = (int)m_drawList.size();
+	m_renderStats.m_numRendererCalls = chunkRenderer.GetNumCalls();
+	m_renderStats.m_numDrawCalls = chunkRenderer.GetNumDrawCalls();
+	m_renderStats.m_numVertexesDrawn = chunkRenderer.GetNumVertexesDrawn();
+	m_renderStats.m_numOutOfOrderVertexes = CountOutOfOrderVertexes(cameraPosition, m_drawList, chunkRenderer.GetDraws());
+	m_renderStats.m_visibilitySeconds = submissionStartSeconds - visibilityStartSeconds;
+	m_renderStats.m_submissionSeconds = submissionEndSeconds - submissionStartSeconds;
 }
 
 void World::AddChunk(const ChunkCoords& chunkCoords, Chunk* newChunk)
 {
 	m_chunks[chunkCoords] = newChunk;
+	m_chunkTree.AddChunk(newChunk);
+	AssignLightingSlot(newChunk);
+	newChunk->ApplySkyLightLevel(m_skyLightLevel);
+	m_isDrawListDirty = true;
 }
 
 Chunk* World::GetChunk(const ChunkCoords& chunkCoords)
@@ -48,8 +227,20 @@ int World::GetNumCurrentChunks() const
 	return m_numCurrentChunks;
 }
 
+void World::CalcLoadedChunkMeshTotals(unsigned int& out_numFaces, unsigned int& out_numVertexBytes) const
+{
+	out_numFaces = 0;
+	out_numVertexBytes = 0;
+	for (std::map<ChunkCoords, Chunk*>::const_iterator chunkIter = m_chunks.begin(); chunkIter != m_chunks.end(); ++chunkIter)
+	{
+		out_numFaces += chunkIter->second->GetNumVertexes() / VERTEXES_PER_FACE;
+		out_numVertexBytes += chunkIter->second->GetNumVertexBytes();
+	}
+}
+
 void World::ActivateChunk(const ChunkCoords& chunkCoords)
 {
+	double activationStartSeconds = GetCurrentTimeSeconds();
 	Chunk* newChunk = new Chunk(chunkCoords);
 
 	Chunk* northNeighbor = GetChunk(ChunkCoords(chunkCoords.x, chunkCoords.y + 1));
@@ -73,8 +264,27 @@ void World::ActivateChunk(const ChunkCoords& chunkCoords)
 	newChunk->SetWestNeighbor(westNeighbor);
 
 	m_chunks[chunkCoords] = newChunk;
-	newChunk->GenerateChunk();
+	m_chunkTree.AddChunk(newChunk);
+	AssignLightingSlot(newChunk);
+	newChunk->ApplySkyLightLevel(m_skyLightLevel);
+	m_isDrawListDirty = true;
+	std::vector<DecorationWrite> outsideWrites;
+	newChunk->GenerateChunk(m_terrainGenerator, m_terrainColumnCache, outsideWrites, &m_generationProfile);
+
+	//Decorations from neighbors generated before this chunk, then this chunk's own reaching into its neighbors
+	std::vector<DecorationWrite> pendingWrites;
+	m_decorationWriteStore.TakeWrites(chunkCoords, pendingWrites);
+	newChunk->ApplyGeneratedDecorationWrites(pendingWrites);
+	DeliverDecorationWrites(outsideWrites);
+
+	int numLightEntriesBefore = m_dirtyLightingQueue.GetSize() + m_lightAddQueue.GetSize() + m_farLightAddQueue.GetSize();
+	double lightingStartSeconds = GetCurrentTimeSeconds();
 	newChunk->InitializeLighting();
+	double activationEndSeconds = GetCurrentTimeSeconds();
+	m_numActivationLightEntries += m_dirtyLightingQueue.GetSize() + m_lightAddQueue.GetSize() + m_farLightAddQueue.GetSize() - numLightEntriesBefore;
+	m_lightingInitializationSeconds += activationEndSeconds - lightingStartSeconds;
+	m_activationSeconds += activationEndSeconds - activationStartSeconds;
+	++m_numLightingActivations;
 
 	++m_numCurrentChunks;
 }
@@ -97,13 +307,63 @@ void World::DeactivateChunk(Chunk* chunk)
 	if (westNeighbor)
 		westNeighbor->SetEastNeighbor(nullptr);
 
+	//Writes from chunks generated so far go to disk with each saved chunk, so a crash can't leave a saved tree cut off at the border
 	chunk->SaveToFile();
+	m_decorationWriteStore.SaveToFiles();
+	m_chunkTree.RemoveChunk(chunk);
+	ReleaseLightingSlot(chunk);
+	m_isDrawListDirty = true;
 	m_chunks.erase(chunkToDeleteCoords);
 	delete chunk;
+	EvictUnneededTerrainColumns(chunkToDeleteCoords);
 
 	--m_numCurrentChunks;
 }
 
+void World::DeliverDecorationWrites(const std::vector<DecorationWrite>& writes)
+{
+	//Loaded chunks take the blocks now, like any other edit, the rest wait in the store until their chunk is generated or loaded
+	std::vector<DecorationWrite> unloadedWrites;
+	for (size_t writeIndex = 0; writeIndex < writes.size(); ++writeIndex)
+	{
+		const DecorationWrite& write = writes[writeIndex];
+		Chunk* targetChunk = GetChunk(write.m_chunkCoords);
+		if (!targetChunk)
+		{
+			unloadedWrites.push_back(write);
+			continue;
+		}
+
+		BlockInfo targetBlock(targetChunk, write.m_blockIndex);
+		BlockType targetType = targetBlock.GetBlock()->GetBlockType();
+		if (CanDecorationReplace(targetType, write.m_blockType))
+			SetBlockType(targetBlock, write.m_blockType);
+	}
+	m_decorationWriteStore.AddWrites(unloadedWrites);
+}
+
+void World::EvictUnneededTerrainColumns(const ChunkCoords& removedChunkCoords)
+{
+	//Cached columns are kept while a loaded chunk is next to them, since only chunks generating beside it sample them
+	for (int tileY = removedChunkCoords.y - 1; tileY <= removedChunkCoords.y + 1; ++tileY)
+	{
+		for (int tileX = removedChunkCoords.x - 1; tileX <= removedChunkCoords.x + 1; ++tileX)
+		{
+			bool isTileNeeded = false;
+			for (int chunkY = tileY - 1; chunkY <= tileY + 1 && !isTileNeeded; ++chunkY)
+			{
+				for (int chunkX = tileX - 1; chunkX <= tileX + 1 && !isTileNeeded; ++chunkX)
+				{
+					isTileNeeded = m_chunks.find(ChunkCoords(chunkX, chunkY)) != m_chunks.end();
+				}
+			}
+
+			if (!isTileNeeded)
+				m_terrainColumnCache.EvictTile(ChunkCoords(tileX, tileY));
+		}
+	}
+}
+
 Chunk* World::FindFurthestChunk(const Vector3& position)
 {
 	Chunk* furthestChunk = new Chunk();
@@ -221,98 +481,104 @@ IntVector3 World::GetBlockCoordsFromWorldCoords(const Vector3& worldPosition)
 	return IntVector3(blockCoordX, blockCoordY, (int)floor(worldPosition.z));
 }
 
-void World::UpdateBlockLighting(BlockInfo& blockInfo)
+void World::SetBlockType(BlockInfo& blockInfo, BlockType newType)
 {
 	Block* block = blockInfo.GetBlock();
-
-	//calculate ideal
-	unsigned int idealLightValue = BlockDefinition::s_blockDefinitions[block->GetBlockType()]->m_selfIlluminationValue;
-
-	if (block->GetIsSky() && SKY_LIGHT_VALUE > idealLightValue)
+	bool wasOpaque = block->GetIsOpaque();
+	block->ChangeType(newType);
+	blockInfo.m_chunk->MakeDirty();
+	DirtyBlockLighting(blockInfo);
+
+	//Only edits at the top of a column move its sky height, anything deeper leaves the heightmap alone
+	bool isOpaque = block->GetIsOpaque();
+	Chunk* chunk = blockInfo.m_chunk;
+	int columnIndex = blockInfo.m_blockIndex & (BLOCKS_PER_LAYER - 1);
+	int blockZ = blockInfo.m_blockIndex >> CHUNK_XY_BITS;
+	int oldSkyHeight = chunk->GetSkyHeight(columnIndex);
+	int newSkyHeight = oldSkyHeight;
+
+	if (isOpaque && !wasOpaque && blockZ >= oldSkyHeight)
 	{
-		idealLightValue = SKY_LIGHT_VALUE;
+		newSkyHeight = blockZ + 1;
 	}
-
-	BlockInfo topNeighbor = blockInfo.GetAboveBlock();
-	BlockInfo bottomNeighbor = blockInfo.GetBelowBlock();
-	BlockInfo northNeighbor = blockInfo.GetNorthBlock();
-	BlockInfo southNeighbor = blockInfo.GetSouthBlock();
-	BlockInfo eastNeighbor = blockInfo.GetEastBlock();
-	BlockInfo westNeighbor = blockInfo.GetWestBlock();
-
-	//check neighbors, if not opaque
-	if(!blockInfo.GetBlock()->GetIsOpaque())
+	else if (!isOpaque && wasOpaque && blockZ + 1 == oldSkyHeight)
 	{
-		if (topNeighbor.m_chunk)
+		newSkyHeight = blockZ;
+		while (newSkyHeight > 0 && !chunk->GetBlockFromBlockIndex(columnIndex + ((newSkyHeight - 1) << CHUNK_XY_BITS))->GetIsOpaque())
 		{
-			unsigned int topLightValue = topNeighbor.GetBlock()->GetLightValue();
-			if (topLightValue > 0)
-				--topLightValue;
-
-			if (topLightValue > idealLightValue)
-				idealLightValue = topLightValue;
-		}
-
-		if (bottomNeighbor.m_chunk)
-		{
-			unsigned int bottomLightValue = bottomNeighbor.GetBlock()->GetLightValue();
-			if (bottomLightValue > 0)
-				--bottomLightValue;
-
-			if (bottomLightValue > idealLightValue)
-				idealLightValue = bottomLightValue;
+			--newSkyHeight;
 		}
+	}
 
-		if (northNeighbor.m_chunk)
-		{
-			unsigned int northLightValue = northNeighbor.GetBlock()->GetLightValue();
-			if (northLightValue > 0)
-				--northLightValue;
+	if (newSkyHeight == oldSkyHeight)
+		return;
 
-			if (northLightValue > idealLightValue)
-				idealLightValue = northLightValue;
-		}
+	//Blocks between the old and new heights gained or lost the sky
+	chunk->SetSkyHeight(columnIndex, newSkyHeight);
+	int lowestChangedZ = (newSkyHeight < oldSkyHeight) ? newSkyHeight : oldSkyHeight;
+	int highestChangedZ = (newSkyHeight < oldSkyHeight) ? oldSkyHeight : newSkyHeight;
+	for (int zIndex = lowestChangedZ; zIndex < highestChangedZ; ++zIndex)
+	{
+		BlockInfo changedBlock(chunk, columnIndex + (zIndex << CHUNK_XY_BITS));
+		DirtyBlockLighting(changedBlock);
+	}
+}
 
-		if (southNeighbor.m_chunk)
-		{
-			unsigned int southLightValue = southNeighbor.GetBlock()->GetLightValue();
-			if (southLightValue > 0)
-				--southLightValue;
+void World::RunLightingBenchmark(const Vector3& position)
+{
+	//Finish any outstanding lighting so each edit's work is measured on its own
+	FinishLighting();
 
-			if (southLightValue > idealLightValue)
-				idealLightValue = southLightValue;
-		}
+	for (int editIndex = 0; editIndex < NUM_LIGHTING_BENCHMARK_EDITS; ++editIndex)
+	{
+		m_lightingBenchmarkResults[editIndex] = LightingWorkStats();
+	}
+	m_hasLightingBenchmarkResults = false;
 
-		if (eastNeighbor.m_chunk)
-		{
-			unsigned int eastLightValue = eastNeighbor.GetBlock()->GetLightValue();
-			if (eastLightValue > 0)
-				--eastLightValue;
+	BlockInfo sourceBlock = GetBlockInfoFromWorldCoords(position);
+	if (!sourceBlock.m_chunk || sourceBlock.GetBlock()->GetIsOpaque())
+		return;
 
-			if (eastLightValue > idealLightValue)
-				idealLightValue = eastLightValue;
-		}
+	BlockType originalSourceType = sourceBlock.GetBlock()->GetBlockType();
+	SetBlockType(sourceBlock, BLOCK_TYPE_GLOWSTONE);
+	FinishLighting();
+	m_lightingBenchmarkResults[LIGHTING_BENCHMARK_PLACE_SOURCE] = m_lightingStats;
 
-		if (westNeighbor.m_chunk)
-		{
-			unsigned int westLightValue = westNeighbor.GetBlock()->GetLightValue();
-			if (westLightValue > 0)
-				--westLightValue;
+	SetBlockType(sourceBlock, originalSourceType);
+	FinishLighting();
+	m_lightingBenchmarkResults[LIGHTING_BENCHMARK_REMOVE_SOURCE] = m_lightingStats;
 
-			if (westLightValue > idealLightValue)
-				idealLightValue = westLightValue;
-		}
+	//Roof the open column at the top of the world, shading everything down to the ground
+	BlockInfo roofBlock(sourceBlock.m_chunk, sourceBlock.m_chunk->GetBlockIndexForBlockCoords(IntVector3(sourceBlock.m_blockIndex & X_MASK_BITS, (sourceBlock.m_blockIndex & Y_MASK_BITS) >> CHUNK_X_BITS, CHUNK_Z - 1)));
+	if (roofBlock.m_chunk->IsSkyBlock(roofBlock.m_blockIndex))
+	{
+		BlockType originalRoofType = roofBlock.GetBlock()->GetBlockType();
+		SetBlockType(roofBlock, BLOCK_TYPE_STONE);
+		FinishLighting();
+		m_lightingBenchmarkResults[LIGHTING_BENCHMARK_ROOF_COLUMN] = m_lightingStats;
+
+		SetBlockType(roofBlock, originalRoofType);
+		FinishLighting();
+		m_lightingBenchmarkResults[LIGHTING_BENCHMARK_UNROOF_COLUMN] = m_lightingStats;
 	}
 
-	//if already ideal, return
-	if (idealLightValue == block->GetLightValue())
-		return;
+	m_hasLightingBenchmarkResults = true;
+}
 
+unsigned int World::GetLightSourceValue(const BlockInfo& blockInfo, LightChannel channel) const
+{
+	if (channel == LIGHT_CHANNEL_SKY)
+		return blockInfo.m_chunk->IsSkyBlock(blockInfo.m_blockIndex) ? SKY_LIGHT_VALUE : 0;
+	return BlockDefinition::s_blockDefinitions[blockInfo.GetBlock()->GetBlockType()]->m_selfIlluminationValue;
+}
 
-	//set to ideal
-	block->SetLightValue(idealLightValue);
+void World::SetBlockLightValue(BlockInfo& blockInfo, LightChannel channel, unsigned int lightValue)
+{
+	blockInfo.GetBlock()->SetLightValue(channel, lightValue);
 	blockInfo.m_chunk->m_isVBODirty = true;
+	++m_lightingStats.m_numLightChanges;
 
+	//Faces of blocks in neighboring chunks are lit by this block too
 	if ((blockInfo.m_blockIndex & X_MASK_BITS) == X_MASK_BITS && blockInfo.m_chunk->GetEastNeighbor())
 	{
 		blockInfo.m_chunk->GetEastNeighbor()->MakeDirty();
@@ -330,25 +596,123 @@ void World::UpdateBlockLighting(BlockInfo& blockInfo)
 	{
 		blockInfo.m_chunk->GetSouthNeighbor()->MakeDirty();
 	}
+}
+
+void World::ResolveDirtyBlockLighting(BlockInfo& blockInfo)
+{
+	Block* block = blockInfo.GetBlock();
+	BlockInfo neighbors[NUM_SECTION_FACES];
+	GetNeighborBlocks(blockInfo, neighbors);
+
+	for (int channelIndex = 0; channelIndex < NUM_LIGHT_CHANNELS; ++channelIndex)
+	{
+		LightChannel channel = (LightChannel)channelIndex;
+		unsigned int currentLightValue = block->GetLightValue(channel);
+		unsigned int sourceLightValue = GetLightSourceValue(blockInfo, channel);
+
+		//Opaque blocks only hold their own light, others can also take light from their brightest neighbor
+		unsigned int expectedLightValue = sourceLightValue;
+		if (!block->GetIsOpaque())
+		{
+			for (int neighborIndex = 0; neighborIndex < NUM_SECTION_FACES; ++neighborIndex)
+			{
+				if (!neighbors[neighborIndex].m_chunk)
+					continue;
+
+				unsigned int neighborLightValue = neighbors[neighborIndex].GetBlock()->GetLightValue(channel);
+				if (neighborLightValue > 0 && neighborLightValue - 1 > expectedLightValue)
+					expectedLightValue = neighborLightValue - 1;
+			}
+		}
+
+		if (expectedLightValue < currentLightValue)
+		{
+			//The light this block had may have reached other blocks, so take it back out before relighting
+			SetBlockLightValue(blockInfo, channel, sourceLightValue);
+			PushLightEntry(m_lightRemovalQueue, blockInfo, channel, currentLightValue);
+			if (sourceLightValue > 0)
+				PushLightAddition(blockInfo, channel);
+		}
+		else if (expectedLightValue > currentLightValue)
+		{
+			SetBlockLightValue(blockInfo, channel, expectedLightValue);
+			PushLightAddition(blockInfo, channel);
+		}
+	}
+}
+
+void World::PropagateLightRemoval(const BlockInfo& blockInfo, LightChannel channel, unsigned int oldLightValue)
+{
+	BlockInfo neighbors[NUM_SECTION_FACES];
+	GetNeighborBlocks(blockInfo, neighbors);
+
+	for (int neighborIndex = 0; neighborIndex < NUM_SECTION_FACES; ++neighborIndex)
+	{
+		BlockInfo& neighbor = neighbors[neighborIndex];
+		if (!neighbor.m_chunk)
+			continue;
+
+		Block* neighborBlock = neighbor.GetBlock();
+		unsigned int neighborLightValue = neighborBlock->GetLightValue(channel);
+		if (neighborLightValue == 0)
+			continue;
+
+		if (neighborBlock->GetIsOpaque())
+		{
+			//Opaque blocks only ever hold their own light, so a lit one is a source bordering the cleared area
+			PushLightAddition(neighbor, channel);
+			continue;
+		}
+
+		if (neighborLightValue < oldLightValue)
+		{
+			//Dimmer neighbors may have been lit through the removed light, so clear them as well
+			unsigned int sourceLightValue = GetLightSourceValue(neighbor, channel);
+			SetBlockLightValue(neighbor, channel, sourceLightValue);
+			PushLightEntry(m_lightRemovalQueue, neighbor, channel, neighborLightValue);
+			if (sourceLightValue > 0)
+				PushLightAddition(neighbor, channel);
+		}
+		else
+		{
+			//Equal or brighter neighbors have another source and will relight the cleared area
+			PushLightAddition(neighbor, channel);
+		}
+	}
+}
 
-	//dirty neighbors
-	if (topNeighbor.m_chunk && !topNeighbor.GetBlock()->GetIsOpaque())
-		DirtyBlockLighting(topNeighbor);
+void World::PropagateLightAddition(const BlockInfo& blockInfo, LightChannel channel)
+{
+	unsigned int lightValue = blockInfo.GetBlock()->GetLightValue(channel);
+	if (lightValue <= 1)
+		return;
 
-	if (bottomNeighbor.m_chunk && !bottomNeighbor.GetBlock()->GetIsOpaque())
-		DirtyBlockLighting(bottomNeighbor);
+	BlockInfo neighbors[NUM_SECTION_FACES];
+	GetNeighborBlocks(blockInfo, neighbors);
 
-	if (northNeighbor.m_chunk && !northNeighbor.GetBlock()->GetIsOpaque())
-		DirtyBlockLighting(northNeighbor);
+	for (int neighborIndex = 0; neighborIndex < NUM_SECTION_FACES; ++neighborIndex)
+	{
+		BlockInfo& neighbor = neighbors[neighborIndex];
+		if (!neighbor.m_chunk)
+			continue;
 
-	if (southNeighbor.m_chunk && !southNeighbor.GetBlock()->GetIsOpaque())
-		DirtyBlockLighting(southNeighbor);
+		Block* neighborBlock = neighbor.GetBlock();
+		if (neighborBlock->GetIsOpaque() || neighborBlock->GetLightValue(channel) >= lightValue - 1)
+			continue;
 
-	if (eastNeighbor.m_chunk && !eastNeighbor.GetBlock()->GetIsOpaque())
-		DirtyBlockLighting(eastNeighbor);
+		SetBlockLightValue(neighbor, channel, lightValue - 1);
+		PushLightAddition(neighbor, channel);
+	}
+}
 
-	if (westNeighbor.m_chunk && !westNeighbor.GetBlock()->GetIsOpaque())
-		DirtyBlockLighting(westNeighbor);
+void World::GetNeighborBlocks(const BlockInfo& blockInfo, BlockInfo* out_neighbors) const
+{
+	out_neighbors[SECTION_FACE_BOTTOM] = blockInfo.GetBelowBlock();
+	out_neighbors[SECTION_FACE_TOP] = blockInfo.GetAboveBlock();
+	out_neighbors[SECTION_FACE_NORTH] = blockInfo.GetNorthBlock();
+	out_neighbors[SECTION_FACE_SOUTH] = blockInfo.GetSouthBlock();
+	out_neighbors[SECTION_FACE_EAST] = blockInfo.GetEastBlock();
+	out_neighbors[SECTION_FACE_WEST] = blockInfo.GetWestBlock();
 }
 
 void World::ManageChunks(const Vector3& playerPosition)
@@ -376,17 +740,380 @@ void World::UpdateChunks(float deltaSeconds)
 	}
 }
 
-void World::UpdateLighting()
+void World::UpdateLighting(int maxVisits)
 {
-	while (!m_dirtyLightingQueue.empty())
+	double startSeconds = GetCurrentTimeSeconds();
+	m_lightingStats = LightingWorkStats();
+	m_dirtyLightingQueue.ResetPeakSize();
+	m_lightRemovalQueue.ResetPeakSize();
+	m_lightAddQueue.ResetPeakSize();
+	m_farLightAddQueue.ResetPeakSize();
+	int numVisits = 0;
+
+	//Edited blocks decide whether their light went up or down
+	while (numVisits < maxVisits && !m_dirtyLightingQueue.IsEmpty())
 	{
-		BlockInfo& block = m_dirtyLightingQueue.front();
-		m_dirtyLightingQueue.pop_front();
+		BlockInfo block = PopLightEntry(m_dirtyLightingQueue);
+		++m_lightingStats.m_numBlocksDirtied;
+		++numVisits;
+		if (!block.m_chunk)
+			continue;
+
 		block.GetBlock()->ClearIsLightingDirty();
-		UpdateBlockLighting(block);
+		ResolveDirtyBlockLighting(block);
+	}
+
+	//Un-light everything that depended on light that went away, collecting the edges that still have light
+	while (numVisits < maxVisits && !m_lightRemovalQueue.IsEmpty())
+	{
+		LightChannel channel;
+		unsigned int oldLightValue = 0;
+		BlockInfo block = PopLightEntry(m_lightRemovalQueue, &channel, &oldLightValue);
+		++m_lightingStats.m_numRemovalVisits;
+		++numVisits;
+		if (block.m_chunk)
+			PropagateLightRemoval(block, channel, oldLightValue);
+	}
+
+	//Flood known light values outward once nothing is left to remove, starting with the blocks around the player
+	if (m_lightRemovalQueue.IsEmpty() && m_isParallelLightingEnabled)
+	{
+		PropagateLightAdditionInParallel(maxVisits, numVisits);
+	}
+	else if (m_lightRemovalQueue.IsEmpty())
+	{
+		while (numVisits < maxVisits && !m_lightAddQueue.IsEmpty())
+		{
+			LightChannel channel;
+			BlockInfo block = PopLightEntry(m_lightAddQueue, &channel);
+			++m_lightingStats.m_numAddVisits;
+			++numVisits;
+			if (block.m_chunk)
+				PropagateLightAddition(block, channel);
+		}
+
+		while (numVisits < maxVisits && m_lightAddQueue.IsEmpty() && !m_farLightAddQueue.IsEmpty())
+		{
+			LightChannel channel;
+			BlockInfo block = PopLightEntry(m_farLightAddQueue, &channel);
+			++m_lightingStats.m_numAddVisits;
+			++numVisits;
+			if (block.m_chunk)
+				PropagateLightAddition(block, channel);
+		}
+	}
+
+	const LightQueue* queues[] = { &m_dirtyLightingQueue, &m_lightRemovalQueue, &m_lightAddQueue, &m_farLightAddQueue };
+	for (int queueIndex = 0; queueIndex < 4; ++queueIndex)
+	{
+		if (queues[queueIndex]->GetPeakSize() > m_lightingStats.m_peakQueueDepth)
+			m_lightingStats.m_peakQueueDepth = queues[queueIndex]->GetPeakSize();
+		m_lightingStats.m_numEntriesCarriedOver += queues[queueIndex]->GetSize();
+	}
+
+	m_lightingStats.m_seconds = GetCurrentTimeSeconds() - startSeconds;
+}
+
+void World::FinishLighting()
+{
+	while (!m_dirtyLightingQueue.IsEmpty() || !m_lightRemovalQueue.IsEmpty() || !m_lightAddQueue.IsEmpty() || !m_farLightAddQueue.IsEmpty())
+	{
+		UpdateLighting(INT_MAX);
 	}
 }
 
+void World::PropagateLightAdditionInParallel(int maxVisits, int& numVisits)
+{
+	//Split the queued additions into a job per chunk
+	LightChannel channel;
+	while (!m_lightAddQueue.IsEmpty())
+	{
+		BlockInfo block = PopLightEntry(m_lightAddQueue, &channel);
+		if (block.m_chunk)
+			ScheduleParallelLightAddition(block, channel);
+	}
+	while (!m_farLightAddQueue.IsEmpty())
+	{
+		BlockInfo block = PopLightEntry(m_farLightAddQueue, &channel);
+		if (block.m_chunk)
+			ScheduleParallelLightAddition(block, channel);
+	}
+
+	std::vector<ChunkLightingJob*> roundJobs;
+	while (!m_scheduledLightingJobs.empty() && numVisits < maxVisits)
+	{
+		roundJobs.swap(m_scheduledLightingJobs);
+		m_scheduledLightingJobs.clear();
+		for (size_t jobIndex = 0; jobIndex < roundJobs.size(); ++jobIndex)
+		{
+			roundJobs[jobIndex]->m_isScheduled = false;
+		}
+
+		int numJobsRun = m_lightingWorkerPool.RunJobs(roundJobs, maxVisits - numVisits);
+
+		//Jobs the budget stopped before they started keep their entries for the next round
+		for (size_t jobIndex = numJobsRun; jobIndex < roundJobs.size(); ++jobIndex)
+		{
+			roundJobs[jobIndex]->m_isScheduled = true;
+			m_scheduledLightingJobs.push_back(roundJobs[jobIndex]);
+		}
+
+		//Exchange light across chunk borders on this thread, the receiving chunks spread it in the next round
+		for (size_t jobIndex = 0; jobIndex < (size_t)numJobsRun; ++jobIndex)
+		{
+			ChunkLightingJob* job = roundJobs[jobIndex];
+			numVisits += job->m_numVisits;
+			m_lightingStats.m_numAddVisits += job->m_numVisits;
+			m_lightingStats.m_numLightChanges += job->m_numLightChanges;
+			job->m_numVisits = 0;
+			job->m_numLightChanges = 0;
+			job->MarkLitEdgeNeighborsDirty();
+
+			for (size_t borderIndex = 0; borderIndex < job->m_outgoingLight.size(); ++borderIndex)
+			{
+				const BorderLight& borderLight = job->m_outgoingLight[borderIndex];
+				BlockInfo target(borderLight.m_targetChunk, borderLight.m_blockIndex);
+				Block* targetBlock = target.GetBlock();
+				if (targetBlock->GetIsOpaque() || targetBlock->GetLightValue(borderLight.m_channel) >= borderLight.m_lightValue)
+					continue;
+
+				SetBlockLightValue(target, borderLight.m_channel, borderLight.m_lightValue);
+				ScheduleParallelLightAddition(target, borderLight.m_channel);
+			}
+			job->m_outgoingLight.clear();
+		}
+		roundJobs.clear();
+	}
+
+	//Out of budget, hand what is left back to the queues for the next frame
+	for (size_t jobIndex = 0; jobIndex < m_scheduledLightingJobs.size(); ++jobIndex)
+	{
+		ChunkLightingJob* job = m_scheduledLightingJobs[jobIndex];
+		for (size_t entryIndex = 0; entryIndex < job->m_entries.size(); ++entryIndex)
+		{
+			unsigned int entry = job->m_entries[entryIndex];
+			PushLightAddition(BlockInfo(job->m_chunk, GetLightJobEntryBlockIndex(entry)), GetLightJobEntryChannel(entry));
+		}
+		job->Reset(job->m_chunk);
+	}
+	m_scheduledLightingJobs.clear();
+}
+
+void World::ScheduleParallelLightAddition(const BlockInfo& blockInfo, LightChannel channel)
+{
+	ChunkLightingJob& job = m_lightingJobs[blockInfo.m_chunk->GetLightingSlot()];
+	if (!job.m_isScheduled)
+	{
+		job.Reset(blockInfo.m_chunk);
+		job.m_isScheduled = true;
+		m_scheduledLightingJobs.push_back(&job);
+	}
+
+	job.AddBlock(blockInfo.m_blockIndex, channel);
+}
+
+void World::RunLightingDeterminismCheck(const Vector3& position)
+{
+	FinishLighting();
+	m_hasLightingDeterminismResult = false;
+
+	BlockInfo sourceBlock = GetBlockInfoFromWorldCoords(position);
+	if (!sourceBlock.m_chunk || sourceBlock.GetBlock()->GetIsOpaque())
+		return;
+
+	BlockInfo roofBlock(sourceBlock.m_chunk, sourceBlock.m_chunk->GetBlockIndexForBlockCoords(IntVector3(sourceBlock.m_blockIndex & X_MASK_BITS, (sourceBlock.m_blockIndex & Y_MASK_BITS) >> CHUNK_X_BITS, CHUNK_Z - 1)));
+	bool shouldRoofColumn = roofBlock.m_blockIndex != sourceBlock.m_blockIndex && roofBlock.m_chunk->IsSkyBlock(roofBlock.m_blockIndex);
+	BlockType originalSourceType = sourceBlock.GetBlock()->GetBlockType();
+	BlockType originalRoofType = roofBlock.GetBlock()->GetBlockType();
+	bool wasParallelLightingEnabled = m_isParallelLightingEnabled;
+
+	//Make the same edits with the serial and the parallel additions, then compare every light value
+	std::vector<unsigned char> lightValuesByPath[2];
+	for (int pathIndex = 0; pathIndex < 2; ++pathIndex)
+	{
+		m_isParallelLightingEnabled = (pathIndex == 1);
+
+		SetBlockType(sourceBlock, BLOCK_TYPE_GLOWSTONE);
+		if (shouldRoofColumn)
+			SetBlockType(roofBlock, BLOCK_TYPE_STONE);
+		FinishLighting();
+		CaptureLightValues(lightValuesByPath[pathIndex]);
+
+		if (shouldRoofColumn)
+			SetBlockType(roofBlock, originalRoofType);
+		SetBlockType(sourceBlock, originalSourceType);
+		FinishLighting();
+	}
+	m_isParallelLightingEnabled = wasParallelLightingEnabled;
+
+	m_numLightingDeterminismMismatches = 0;
+	for (size_t valueIndex = 0; valueIndex < lightValuesByPath[0].size(); ++valueIndex)
+	{
+		if (lightValuesByPath[0][valueIndex] != lightValuesByPath[1][valueIndex])
+			++m_numLightingDeterminismMismatches;
+	}
+	m_hasLightingDeterminismResult = true;
+}
+
+void World::CaptureLightValues(std::vector<unsigned char>& out_lightValues)
+{
+	out_lightValues.clear();
+	out_lightValues.reserve(m_chunks.size() * BLOCKS_PER_CHUNK);
+	for (std::map<ChunkCoords, Chunk*>::iterator chunkIter = m_chunks.begin(); chunkIter != m_chunks.end(); ++chunkIter)
+	{
+		for (int blockIndex = 0; blockIndex < BLOCKS_PER_CHUNK; ++blockIndex)
+		{
+			out_lightValues.push_back(chunkIter->second->GetBlockFromBlockIndex(blockIndex)->GetPackedLightValues());
+		}
+	}
+}
+
+void World::PushLightAddition(const BlockInfo& blockInfo, LightChannel channel)
+{
+	const ChunkCoords& chunkCoords = blockInfo.m_chunk->GetChunkCoords();
+	if (abs(chunkCoords.x - m_lightingFocusChunkCoords.x) <= LIGHTING_PRIORITY_CHUNK_RADIUS && abs(chunkCoords.y - m_lightingFocusChunkCoords.y) <= LIGHTING_PRIORITY_CHUNK_RADIUS)
+	{
+		PushLightEntry(m_lightAddQueue, blockInfo, channel);
+	}
+	else
+	{
+		PushLightEntry(m_farLightAddQueue, blockInfo, channel);
+	}
+}
+
+BlockInfo World::PopLightEntry(LightQueue& queue, LightChannel* out_channel, unsigned int* out_lightValue)
+{
+	unsigned int entry = queue.Pop();
+	if (out_channel)
+		*out_channel = GetLightEntryChannel(entry);
+	if (out_lightValue)
+		*out_lightValue = GetLightEntryLightValue(entry);
+
+	//Entries for chunks deactivated since they were queued come back with a null chunk
+	int slotIndex = GetLightEntryChunkSlot(entry);
+	Chunk* chunk = m_lightingSlots[slotIndex];
+	--m_numPendingEntriesInSlot[slotIndex];
+	if (!chunk && m_numPendingEntriesInSlot[slotIndex] == 0)
+	{
+		m_freeLightingSlots.push_back(slotIndex);
+	}
+
+	return BlockInfo(chunk, GetLightEntryBlockIndex(entry));
+}
+
+void World::AssignLightingSlot(Chunk* chunk)
+{
+	int slotIndex;
+	if (!m_freeLightingSlots.empty())
+	{
+		slotIndex = m_freeLightingSlots.back();
+		m_freeLightingSlots.pop_back();
+	}
+	else
+	{
+		ASSERT_OR_DIE((int)m_lightingSlots.size() < MAX_LIGHTING_SLOTS, "Ran out of chunk lighting slots.");
+		slotIndex = (int)m_lightingSlots.size();
+		m_lightingSlots.push_back(nullptr);
+		m_numPendingEntriesInSlot.push_back(0);
+		m_lightingJobs.push_back(ChunkLightingJob());
+	}
+
+	m_lightingSlots[slotIndex] = chunk;
+	chunk->SetLightingSlot(slotIndex);
+}
+
+void World::ReleaseLightingSlot(Chunk* chunk)
+{
+	//Queued entries may still name this slot, so it is handed out again only once the last of them is popped
+	int slotIndex = chunk->GetLightingSlot();
+	m_lightingSlots[slotIndex] = nullptr;
+	if (m_numPendingEntriesInSlot[slotIndex] == 0)
+	{
+		m_freeLightingSlots.push_back(slotIndex);
+	}
+	chunk->SetLightingSlot(-1);
+}
+
+void World::UpdateSkyLightLevel(float deltaSeconds)
+{
+	if (!m_isDayNightCycleEnabled)
+		return;
+
+	m_timeOfDay += deltaSeconds / DAY_LENGTH_SECONDS;
+	m_timeOfDay -= floor(m_timeOfDay);
+
+	float daylight = 0.5f + (0.5f * CosDegrees(m_timeOfDay * 360.f));
+	unsigned int skyLightLevel = (unsigned int)(RangeMapFloat(daylight, 0.f, 1.f, (float)NIGHT_SKY_LIGHT_LEVEL, (float)SKY_LIGHT_VALUE) + 0.5f);
+	SetSkyLightLevel(skyLightLevel);
+}
+
+void World::SetSkyLightLevel(unsigned int skyLightLevel)
+{
+	if (skyLightLevel == m_skyLightLevel)
+		return;
+
+	//Sky light is stored apart from block light, so a new sky level only recolors the existing meshes
+	m_skyLightLevel = skyLightLevel;
+	for (std::map<ChunkCoords, Chunk*>::iterator chunkIter = m_chunks.begin(); chunkIter != m_chunks.end(); ++chunkIter)
+	{
+		chunkIter->second->ApplySkyLightLevel(m_skyLightLevel);
+	}
+	m_farTerrain.SetSkyLightLevel(m_skyLightLevel);
+}
+
+void World::ToggleDayNightCycle()
+{
+	m_isDayNightCycleEnabled = !m_isDayNightCycleEnabled;
+
+	//Without the cycle the world goes back to noon instead of staying at whatever time it was stopped
+	if (!m_isDayNightCycleEnabled)
+	{
+		m_timeOfDay = 0.f;
+		SetSkyLightLevel(SKY_LIGHT_VALUE);
+	}
+}
+
+void World::UpdateLevelsOfDetail(const Vector3& playerPosition)
+{
+	for (int lodLevel = 0; lodLevel < NUM_LOD_LEVELS; ++lodLevel)
+	{
+		m_numChunksAtLodLevel[lodLevel] = 0;
+	}
+
+	Vector2 playerPositionXY(playerPosition.x, playerPosition.y);
+	for (std::map<ChunkCoords, Chunk*>::iterator chunkIter = m_chunks.begin(); chunkIter != m_chunks.end(); ++chunkIter)
+	{
+		Chunk* chunk = chunkIter->second;
+		int lodLevel = 0;
+		if (m_areLevelsOfDetailEnabled)
+		{
+			Vector2 chunkCenterXY(chunk->GetChunkCenter().x, chunk->GetChunkCenter().y);
+			float distanceToChunk = sqrtf(CalcDistanceSquared(playerPositionXY, chunkCenterXY));
+			lodLevel = CalcLodLevelForDistance(distanceToChunk, chunk->GetLodLevel());
+		}
+
+		chunk->SetLodLevel(lodLevel);
+		++m_numChunksAtLodLevel[lodLevel];
+	}
+}
+
+int World::CalcLodLevelForDistance(float distanceToChunk, int currentLodLevel) const
+{
+	int lodLevel = 0;
+	for (int coarserLevel = 1; coarserLevel < NUM_LOD_LEVELS; ++coarserLevel)
+	{
+		//Levels the chunk is already at or past only drop back once it is clearly inside the threshold
+		float threshold = LOD_DISTANCES[coarserLevel];
+		if (coarserLevel <= currentLodLevel)
+			threshold -= LOD_HYSTERESIS;
+
+		if (distanceToChunk >= threshold)
+			lodLevel = coarserLevel;
+	}
+
+	return lodLevel;
+}
+
 void World::UpdateVertexArrays()
 {
 	std::map<ChunkCoords, Chunk*>::iterator chunkIter = m_chunks.begin();
@@ -394,62 +1121,221 @@ void World::UpdateVertexArrays()
 	{
 		if (chunkIter->second->m_isVBODirty)
 		{
-			chunkIter->second->RebuildVertexArray();
+			//Light still spreading through this chunk would dirty it again, so wait until it settles
+			if (HasPendingLighting(chunkIter->second))
+			{
+				++m_lightingStats.m_numChunkRebuildsDeferred;
+			}
+			else
+			{
+				chunkIter->second->RebuildVertexArray();
+			}
+		}
+
+		if (chunkIter->second->m_hasConnectivityChanged)
+		{
+			chunkIter->second->m_hasConnectivityChanged = false;
+			m_isDrawListDirty = true;
 		}
 	}
 }
 
-bool World::CanPlayerSeeChunk(const Vector3& cameraPosition, const Vector3& cameraForward, Chunk* chunkToSee) const
+bool World::ShouldRebuildDrawList(const Vector3& cameraPosition, const Vector3& cameraForward) const
 {
-	Vector3 displacementToBottomSouthWest = chunkToSee->GetBottomSouthWestCorner() - cameraPosition;
-	if (DotProduct(cameraForward, displacementToBottomSouthWest) > 0.f)
-	{
+	if (GetChunkCoordsFromWorldCoords(cameraPosition) != m_drawListCameraChunkCoords)
+		return true;
+
+	if (((int)floor(cameraPosition.z) >> CHUNK_SECTION_Z_BITS) != m_drawListCameraSectionIndex)
 		return true;
+
+	return DotProduct(cameraForward, m_drawListCameraForward) < DRAW_LIST_REBUILD_MIN_FORWARD_DOT;
+}
+
+void World::RebuildDrawList(const Vector3& cameraPosition, const Vector3& cameraForward) const
+{
+	//A cached list is reused while the camera moves within a chunk, so cull from a point one chunk behind the camera
+	Vector3 cullingPosition = cameraPosition;
+	float cullingRange = VISIBILITY_RANGE;
+	if (m_isDrawListCachingEnabled)
+	{
+		cullingPosition -= cameraForward * DRAW_LIST_CULLING_MARGIN;
+		cullingRange += DRAW_LIST_CULLING_MARGIN;
 	}
 
-	Vector3 displacementToBottomSouthEast = chunkToSee->GetBottomSouthEastCorner() - cameraPosition;
-	if (DotProduct(cameraForward, displacementToBottomSouthEast) > 0.f)
+	CollectChunksToDraw(cameraPosition, cameraForward, cullingPosition, cullingRange, m_drawList, m_renderStats.m_numChunksInFrustum);
+	m_renderStats.m_numCullingTests = m_chunkTree.GetNumNodesTestedLastQuery();
+
+	if (m_isDrawListCachingEnabled)
 	{
-		return true;
+		//Sort front-to-back so early depth testing rejects as much hidden geometry as possible
+		SortChunksFrontToBack(cameraPosition, m_drawList);
 	}
 
-	Vector3 displacementToBottomNorthWest = chunkToSee->GetBottomNorthWestCorner() - cameraPosition;
-	if (DotProduct(cameraForward, displacementToBottomNorthWest) > 0.f)
+	m_drawListCameraChunkCoords = GetChunkCoordsFromWorldCoords(cameraPosition);
+	m_drawListCameraSectionIndex = (int)floor(cameraPosition.z) >> CHUNK_SECTION_Z_BITS;
+	m_drawListCameraForward = cameraForward;
+	m_isDrawListDirty = false;
+	m_renderStats.m_wasDrawListRebuilt = true;
+}
+
+void World::CollectChunksToDraw(const Vector3& cameraPosition, const Vector3& cameraForward, const Vector3& cullingPosition, float cullingRange, std::vector<Chunk*>& out_drawList, int& out_numChunksInFrustum) const
+{
+	out_drawList.clear();
+	out_drawList.reserve(m_chunks.size());
+	m_chunkTree.CollectVisibleChunks(cullingPosition, cameraForward, cullingRange, out_drawList);
+	out_numChunksInFrustum = (int)out_drawList.size();
+
+	if (m_isOcclusionCullingEnabled)
 	{
-		return true;
+		std::vector<Chunk*> unoccludedChunks;
+		unoccludedChunks.reserve(out_drawList.size());
+		CollectUnoccludedChunks(cameraPosition, out_drawList, unoccludedChunks);
+		out_drawList.swap(unoccludedChunks);
 	}
+}
 
-	Vector3 displacementToBottomNorthEast = chunkToSee->GetBottomNorthEastCorner() - cameraPosition;
-	if (DotProduct(cameraForward, displacementToBottomNorthEast) > 0.f)
+void World::RunDrawOrderBenchmark(const Vector3& cameraPosition, const Vector3& cameraForward)
+{
+	//Builds the list the way F3 does with the sort off and on, timing each, then submits both lists to recorders that draw nothing
+	m_drawOrderBenchmarkResult = DrawOrderBenchmarkResult();
+	std::vector<Chunk*> unsortedDrawList;
+	std::vector<Chunk*> sortedDrawList;
+	int numChunksInFrustum = 0;
+
+	double unsortedStartSeconds = GetCurrentTimeSeconds();
+	for (int repeatIndex = 0; repeatIndex < DRAW_ORDER_BENCHMARK_REPEATS; ++repeatIndex)
 	{
-		return true;
+		CollectChunksToDraw(cameraPosition, cameraForward, cameraPosition, VISIBILITY_RANGE, unsortedDrawList, numChunksInFrustum);
 	}
 
-	Vector3 displacementToTopSouthWest = chunkToSee->GetTopSouthWestCorner() - cameraPosition;
-	if (DotProduct(cameraForward, displacementToTopSouthWest) > 0.f)
+	double sortedStartSeconds = GetCurrentTimeSeconds();
+	for (int repeatIndex = 0; repeatIndex < DRAW_ORDER_BENCHMARK_REPEATS; ++repeatIndex)
 	{
-		return true;
+		CollectChunksToDraw(cameraPosition, cameraForward, cameraPosition, VISIBILITY_RANGE, sortedDrawList, numChunksInFrustum);
+		SortChunksFrontToBack(cameraPosition, sortedDrawList);
 	}
 
-	Vector3 displacementToTopSouthEast = chunkToSee->GetTopSouthEastCorner() - cameraPosition;
-	if (DotProduct(cameraForward, displacementToTopSouthEast) > 0.f)
+	double unsortedSubmissionStartSeconds = GetCurrentTimeSeconds();
+	RecordingRenderer unsortedRecorder(nullptr);
+	for (size_t drawIndex = 0; drawIndex < unsortedDrawList.size(); ++drawIndex)
 	{
-		return true;
+		unsortedDrawList[drawIndex]->Render(unsortedRecorder);
 	}
 
-	Vector3 displacementToTopNorthWest = chunkToSee->GetTopNorthWestCorner() - cameraPosition;
-	if (DotProduct(cameraForward, displacementToTopNorthWest) > 0.f)
+	double sortedSubmissionStartSeconds = GetCurrentTimeSeconds();
+	RecordingRenderer sortedRecorder(nullptr);
+	for (size_t drawIndex = 0; drawIndex < sortedDrawList.size(); ++drawIndex)
 	{
-		return true;
+		sortedDrawList[drawIndex]->Render(sortedRecorder);
 	}
+	double endSeconds = GetCurrentTimeSeconds();
+
+	m_drawOrderBenchmarkResult.m_numChunks = (int)sortedDrawList.size();
+	m_drawOrderBenchmarkResult.m_numVertexes = sortedRecorder.GetNumVertexesDrawn();
+	m_drawOrderBenchmarkResult.m_numUnsortedOutOfOrderVertexes = CountOutOfOrderVertexes(cameraPosition, unsortedDrawList, unsortedRecorder.GetDraws());
+	m_drawOrderBenchmarkResult.m_numSortedOutOfOrderVertexes = CountOutOfOrderVertexes(cameraPosition, sortedDrawList, sortedRecorder.GetDraws());
+	m_drawOrderBenchmarkResult.m_unsortedRebuildSeconds = (sortedStartSeconds - unsortedStartSeconds) / (double)DRAW_ORDER_BENCHMARK_REPEATS;
+	m_drawOrderBenchmarkResult.m_sortedRebuildSeconds = (unsortedSubmissionStartSeconds - sortedStartSeconds) / (double)DRAW_ORDER_BENCHMARK_REPEATS;
+	m_drawOrderBenchmarkResult.m_unsortedSubmissionSeconds = sortedSubmissionStartSeconds - unsortedSubmissionStartSeconds;
+	m_drawOrderBenchmarkResult.m_sortedSubmissionSeconds = endSeconds - sortedSubmissionStartSeconds;
+	m_hasDrawOrderBenchmarkResult = true;
+}
 
-	Vector3 displacementToTopNorthEast = chunkToSee->GetTopNorthEastCorner() - cameraPosition;
-	if (DotProduct(cameraForward, displacementToTopNorthEast) > 0.f)
+void World::CollectUnoccludedChunks(const Vector3& cameraPosition, const std::vector<Chunk*>& frustumChunks, std::vector<Chunk*>& out_unoccludedChunks) const
+{
+	++m_renderFrameNumber;
+	for (size_t chunkIndex = 0; chunkIndex < frustumChunks.size(); ++chunkIndex)
 	{
-		return true;
+		frustumChunks[chunkIndex]->m_frustumFrameNumber = m_renderFrameNumber;
 	}
 
-	return false;
+	std::vector<SectionVisit> visitQueue;
+	visitQueue.reserve(frustumChunks.size() * SECTIONS_PER_CHUNK);
+
+	int cameraBlockZ = (int)floor(cameraPosition.z);
+	if (cameraBlockZ >= CHUNK_Z)
+	{
+		//Above the world, every chunk in the frustum can be seen through its top face
+		for (size_t chunkIndex = 0; chunkIndex < frustumChunks.size(); ++chunkIndex)
+		{
+			visitQueue.push_back(SectionVisit(frustumChunks[chunkIndex], SECTIONS_PER_CHUNK - 1, SECTION_FACE_TOP, BIT(SECTION_FACE_BOTTOM)));
+		}
+	}
+	else
+	{
+		std::map<ChunkCoords, Chunk*>::const_iterator found = m_chunks.find(GetChunkCoordsFromWorldCoords(cameraPosition));
+		if (cameraBlockZ < 0 || found == m_chunks.end())
+		{
+			out_unoccludedChunks = frustumChunks;
+			return;
+		}
+
+		found->second->m_frustumFrameNumber = m_renderFrameNumber;
+		visitQueue.push_back(SectionVisit(found->second, cameraBlockZ >> CHUNK_SECTION_Z_BITS, SECTION_FACE_NONE, 0));
+	}
+
+	for (size_t visitIndex = 0; visitIndex < visitQueue.size(); ++visitIndex)
+	{
+		visitQueue[visitIndex].m_chunk->m_sectionVisitedFrameNumbers[visitQueue[visitIndex].m_sectionIndex] = m_renderFrameNumber;
+	}
+
+	//Breadth-first walk outward from the camera, only passing between faces that are connected through the section
+	for (size_t visitIndex = 0; visitIndex < visitQueue.size(); ++visitIndex)
+	{
+		SectionVisit currentVisit = visitQueue[visitIndex];
+		Chunk* currentChunk = currentVisit.m_chunk;
+
+		if (currentChunk->m_drawnFrameNumber != m_renderFrameNumber)
+		{
+			currentChunk->m_drawnFrameNumber = m_renderFrameNumber;
+			out_unoccludedChunks.push_back(currentChunk);
+		}
+
+		for (int faceIndex = 0; faceIndex < NUM_SECTION_FACES; ++faceIndex)
+		{
+			SectionFace exitFace = (SectionFace)faceIndex;
+			SectionFace entryFace = GetOppositeSectionFace(exitFace);
+
+			if (currentVisit.m_travelledFaces & BIT(entryFace))
+				continue;
+			if (!currentChunk->CanSeeThroughSection(currentVisit.m_sectionIndex, currentVisit.m_entryFace, exitFace))
+				continue;
+
+			Chunk* nextChunk = currentChunk;
+			int nextSectionIndex = currentVisit.m_sectionIndex;
+			switch (exitFace)
+			{
+			case SECTION_FACE_BOTTOM:
+				--nextSectionIndex;
+				break;
+			case SECTION_FACE_TOP:
+				++nextSectionIndex;
+				break;
+			case SECTION_FACE_NORTH:
+				nextChunk = currentChunk->GetNorthNeighbor();
+				break;
+			case SECTION_FACE_SOUTH:
+				nextChunk = currentChunk->GetSouthNeighbor();
+				break;
+			case SECTION_FACE_EAST:
+				nextChunk = currentChunk->GetEastNeighbor();
+				break;
+			case SECTION_FACE_WEST:
+				nextChunk = currentChunk->GetWestNeighbor();
+				break;
+			}
+
+			if (!nextChunk || nextSectionIndex < 0 || nextSectionIndex >= SECTIONS_PER_CHUNK)
+				continue;
+			if (nextChunk->m_frustumFrameNumber != m_renderFrameNumber)
+				continue;
+			if (nextChunk->m_sectionVisitedFrameNumbers[nextSectionIndex] == m_renderFrameNumber)
+				continue;
+
+			nextChunk->m_sectionVisitedFrameNumbers[nextSectionIndex] = m_renderFrameNumber;
+			visitQueue.push_back(SectionVisit(nextChunk, nextSectionIndex, entryFace, currentVisit.m_travelledFaces | (unsigned char)BIT(exitFace)));
+		}
+	}
 }
 
 void World::Quit()
@@ -1,25 +1,136 @@
 #pragma once
 #include "Game/Chunk.hpp"
 #include "Game/BlockInfo.hpp"
+#include "Game/ChunkQuadTree.hpp"
+#include "Game/FarTerrain.hpp"
+#include "Game/LightQueue.hpp"
+#include "Game/ChunkLightingJob.hpp"
+#include "Game/RecordingRenderer.hpp"
+#include "Game/TerrainNoise.hpp"
 #include <map>
-#include <deque>
+#include <vector>
 
 
 typedef IntVector2 ChunkCoords;
 
 
+struct SectionVisit
+{
+	Chunk* m_chunk;
+	int m_sectionIndex;
+	SectionFace m_entryFace;
+	unsigned char m_travelledFaces;
+
+	SectionVisit(Chunk* chunk, int sectionIndex, SectionFace entryFace, unsigned char travelledFaces)
+		: m_chunk(chunk)
+		, m_sectionIndex(sectionIndex)
+		, m_entryFace(entryFace)
+		, m_travelledFaces(travelledFaces)
+	{
+	}
+};
+
+
+struct LightingWorkStats
+{
+	int m_numBlocksDirtied;
+	int m_numRemovalVisits;
+	int m_numAddVisits;
+	int m_numLightChanges;
+	int m_peakQueueDepth;
+	int m_numEntriesCarriedOver;		//queued work left for later frames once the budget ran out
+	int m_numChunkRebuildsDeferred;
+	double m_seconds;
+
+	LightingWorkStats();
+};
+
+
+enum LightingBenchmarkEdit
+{
+	LIGHTING_BENCHMARK_PLACE_SOURCE,
+	LIGHTING_BENCHMARK_REMOVE_SOURCE,
+	LIGHTING_BENCHMARK_ROOF_COLUMN,
+	LIGHTING_BENCHMARK_UNROOF_COLUMN,
+	NUM_LIGHTING_BENCHMARK_EDITS
+};
+
+
+struct WorldRenderStats
+{
+	int m_numChunksDrawn;
+	int m_numChunksInFrustum;
+	int m_numCullingTests;
+	int m_numRendererCalls;		//counted by the recording renderer the chunks are submitted through
+	int m_numDrawCalls;
+	int m_numVertexesDrawn;
+	int m_numOutOfOrderVertexes;		//vertexes the recorder saw drawn after a further chunk, which early depth testing can't reject
+	bool m_wasDrawListRebuilt;
+	double m_visibilitySeconds;
+	double m_submissionSeconds;
+
+	WorldRenderStats();
+};
+
+
+//The current view's draw list built without and with the front-to-back sort, each submitted to a recording renderer that draws nothing
+struct DrawOrderBenchmarkResult
+{
+	int m_numChunks;
+	int m_numVertexes;
+	int m_numUnsortedOutOfOrderVertexes;
+	int m_numSortedOutOfOrderVertexes;
+	double m_unsortedRebuildSeconds;		//culling alone, averaged over DRAW_ORDER_BENCHMARK_REPEATS builds
+	double m_sortedRebuildSeconds;		//culling and sorting
+	double m_unsortedSubmissionSeconds;
+	double m_sortedSubmissionSeconds;
+
+	DrawOrderBenchmarkResult();
+};
+
+
 class World
 {
 public:
 	World();
 
-	void Update(float deltaSeconds, const Vector3& playerPosition);
+	void Update(float deltaSeconds, const Vector3& playerPosition, const Vector3& cameraPosition);
 	void Render(const Vector3& cameraPosition, const Vector3& cameraForward) const;
 
 	void AddChunk(const ChunkCoords& chunkCoords, Chunk* newChunk);
 	Chunk* GetChunk(const ChunkCoords& chunkCoords);
 
 	int GetNumCurrentChunks() const;
+	void CalcLoadedChunkMeshTotals(unsigned int& out_numFaces, unsigned int& out_numVertexBytes) const;
+	const WorldRenderStats& GetRenderStats() const;
+
+	void ToggleOcclusionCulling();
+	bool IsOcclusionCullingEnabled() const;
+	void ToggleDrawListCaching();
+	bool IsDrawListCachingEnabled() const;
+	void RunDrawOrderBenchmark(const Vector3& cameraPosition, const Vector3& cameraForward);
+	bool HasDrawOrderBenchmarkResult() const;
+	const DrawOrderBenchmarkResult& GetDrawOrderBenchmarkResult() const;
+	void ToggleLevelsOfDetail();
+	bool AreLevelsOfDetailEnabled() const;
+	int GetNumChunksAtLodLevel(int lodLevel) const;
+	void ToggleDayNightCycle();
+	bool IsDayNightCycleEnabled() const;
+	unsigned int GetSkyLightLevel() const;
+	void ToggleFarTerrain();
+	bool IsFarTerrainEnabled() const;
+	const FarTerrain& GetFarTerrain() const;
+	const TerrainColumnCache& GetTerrainColumnCache() const;
+	const DecorationWriteStore& GetDecorationWriteStore() const;
+	void RunNoiseBenchmark();
+	void RunGenerationDeterminismCheck();
+	bool HasGenerationDeterminismResult() const;
+	const GenerationDeterminismResult& GetGenerationDeterminismResult() const;
+	void RunTreeSiteBenchmark(const Vector3& position);
+	const TreeSiteBenchmarkResult& GetTreeSiteBenchmarkResult() const;
+	const GenerationProfile& GetGenerationProfile() const;
+	bool HasNoiseBenchmarkResult() const;
+	const NoiseBenchmarkResult& GetNoiseBenchmarkResult() const;
 
 	void ActivateChunk(const ChunkCoords& chunkCoords);
 	void DeactivateChunk(Chunk* chunk);
@@ -30,32 +141,343 @@ public:
 	bool IsMissingChunkNear(const Vector3& position);
 	Block* GetBlockFromWorldCoords(const Vector3& worldPosition);
 	BlockInfo GetBlockInfoFromWorldCoords(const Vector3& worldPosition);
-	ChunkCoords GetChunkCoordsFromWorldCoords(const Vector3& worldPosition);
+	ChunkCoords GetChunkCoordsFromWorldCoords(const Vector3& worldPosition) const;
 	IntVector3 GetBlockCoordsFromWorldCoords(const Vector3& worldPosition);
 
+	void SetBlockType(BlockInfo& blockInfo, BlockType newType);
 	void DirtyBlockLighting(BlockInfo& blockInfo);
-	void UpdateBlockLighting(BlockInfo& blockInfo);
+	void QueueLightAddition(const BlockInfo& blockInfo, LightChannel channel);
+
+	void RunLightingBenchmark(const Vector3& position);
+	void SetLightingVisitBudget(int maxVisitsPerFrame);
+	int GetLightingVisitBudget() const;
+	float GetAverageLightEntriesPerActivation() const;
+	double GetAverageActivationSeconds() const;
+	double GetAverageLightingInitializationSeconds() const;
+	void ToggleParallelLighting();
+	bool IsParallelLightingEnabled() const;
+	void RunLightingDeterminismCheck(const Vector3& position);
+	bool HasLightingDeterminismResult() const;
+	int GetNumLightingDeterminismMismatches() const;
+	const LightingWorkStats& GetLightingStats() const;
+	bool HasLightingBenchmarkResults() const;
+	const LightingWorkStats& GetLightingBenchmarkResult(LightingBenchmarkEdit edit) const;
 
 	void Quit();
 
 private:
 	std::map<ChunkCoords, Chunk*> m_chunks;
+	ChunkQuadTree m_chunkTree;
+	TerrainGenerator m_terrainGenerator;
+	TerrainColumnCache m_terrainColumnCache;
 	int m_numCurrentChunks;
+	mutable int m_renderFrameNumber;
+	mutable WorldRenderStats m_renderStats;
+	bool m_isOcclusionCullingEnabled;
+
+	bool m_isDrawListCachingEnabled;
+	mutable bool m_isDrawListDirty;
+	mutable std::vector<Chunk*> m_drawList;
+	mutable ChunkCoords m_drawListCameraChunkCoords;
+	mutable int m_drawListCameraSectionIndex;
+	mutable Vector3 m_drawListCameraForward;
+	bool m_hasDrawOrderBenchmarkResult;
+	DrawOrderBenchmarkResult m_drawOrderBenchmarkResult;
+
+	bool m_areLevelsOfDetailEnabled;
+	int m_numChunksAtLodLevel[NUM_LOD_LEVELS];
 
-	std::deque<BlockInfo> m_dirtyLightingQueue;
+	FarTerrain m_farTerrain;
+	bool m_isFarTerrainEnabled;
+
+	bool m_isDayNightCycleEnabled;
+	float m_timeOfDay;		//0 is noon, 0.5 is midnight
+	unsigned int m_skyLightLevel;
+
+	LightQueue m_dirtyLightingQueue;
+	LightQueue m_lightRemovalQueue;
+	LightQueue m_lightAddQueue;
+	LightQueue m_farLightAddQueue;
+	std::vector<Chunk*> m_lightingSlots;		//chunk for each slot referenced by light queue entries
+	std::vector<int> m_numPendingEntriesInSlot;
+	std::vector<int> m_freeLightingSlots;
+	ChunkCoords m_lightingFocusChunkCoords;
+	int m_lightingVisitBudget;
+	int m_numActivationLightEntries;		//lighting entries queued by chunk activations, for the per-activation average
+	int m_numLightingActivations;
+	double m_activationSeconds;
+	double m_lightingInitializationSeconds;
+	bool m_isParallelLightingEnabled;
+	std::vector<ChunkLightingJob> m_lightingJobs;		//one per lighting slot
+	std::vector<ChunkLightingJob*> m_scheduledLightingJobs;
+	ChunkLightingWorkerPool m_lightingWorkerPool;
+	bool m_hasLightingDeterminismResult;
+	int m_numLightingDeterminismMismatches;
+	LightingWorkStats m_lightingStats;
+	bool m_hasLightingBenchmarkResults;
+	LightingWorkStats m_lightingBenchmarkResults[NUM_LIGHTING_BENCHMARK_EDITS];
+	bool m_hasNoiseBenchmarkResult;
+	NoiseBenchmarkResult m_noiseBenchmarkResult;
+	bool m_hasGenerationDeterminismResult;
+	GenerationDeterminismResult m_generationDeterminismResult;
+	TreeSiteBenchmarkResult m_treeSiteBenchmarkResult;
+	GenerationProfile m_generationProfile;
+	DecorationWriteStore m_decorationWriteStore;
 
 	void ManageChunks(const Vector3& playerPosition);
 	void UpdateChunks(float deltaSeconds);
-	void UpdateLighting();
+	void UpdateLighting(int maxVisits);
+	void FinishLighting();
+	unsigned int GetLightSourceValue(const BlockInfo& blockInfo, LightChannel channel) const;
+	void SetBlockLightValue(BlockInfo& blockInfo, LightChannel channel, unsigned int lightValue);
+	void ResolveDirtyBlockLighting(BlockInfo& blockInfo);
+	void PropagateLightRemoval(const BlockInfo& blockInfo, LightChannel channel, unsigned int oldLightValue);
+	void PropagateLightAddition(const BlockInfo& blockInfo, LightChannel channel);
+	void PropagateLightAdditionInParallel(int maxVisits, int& numVisits);
+	void ScheduleParallelLightAddition(const BlockInfo& blockInfo, LightChannel channel);
+	void CaptureLightValues(std::vector<unsigned char>& out_lightValues);
+	void GetNeighborBlocks(const BlockInfo& blockInfo, BlockInfo* out_neighbors) const;
+	void PushLightEntry(LightQueue& queue, const BlockInfo& blockInfo, LightChannel channel, unsigned int lightValue = 0);
+	void PushLightAddition(const BlockInfo& blockInfo, LightChannel channel);
+	BlockInfo PopLightEntry(LightQueue& queue, LightChannel* out_channel = nullptr, unsigned int* out_lightValue = nullptr);
+	bool HasPendingLighting(const Chunk* chunk) const;
+	void AssignLightingSlot(Chunk* chunk);
+	void ReleaseLightingSlot(Chunk* chunk);
+	void EvictUnneededTerrainColumns(const ChunkCoords& removedChunkCoords);
+	void DeliverDecorationWrites(const std::vector<DecorationWrite>& writes);
+	void UpdateSkyLightLevel(float deltaSeconds);
+	void SetSkyLightLevel(unsigned int skyLightLevel);
+	void UpdateLevelsOfDetail(const Vector3& playerPosition);
+	int CalcLodLevelForDistance(float distanceToChunk, int currentLodLevel) const;
 	void UpdateVertexArrays();
-	bool CanPlayerSeeChunk(const Vector3& cameraPosition, const Vector3& cameraForward, Chunk* chunkToSee) const;
+	bool ShouldRebuildDrawList(const Vector3& cameraPosition, const Vector3& cameraForward) const;
+	void RebuildDrawList(const Vector3& cameraPosition, const Vector3& cameraForward) const;
+	void CollectChunksToDraw(const Vector3& cameraPosition, const Vector3& cameraForward, const Vector3& cullingPosition, float cullingRange, std::vector<Chunk*>& out_drawList, int& out_numChunksInFrustum) const;
+	void CollectUnoccludedChunks(const Vector3& cameraPosition, const std::vector<Chunk*>& frustumChunks, std::vector<Chunk*>& out_unoccludedChunks) const;
 };
 
-inline ChunkCoords World::GetChunkCoordsFromWorldCoords(const Vector3& worldPosition)
+inline ChunkCoords World::GetChunkCoordsFromWorldCoords(const Vector3& worldPosition) const
 {
 	return ChunkCoords((int)floor(worldPosition.x) >> CHUNK_X_BITS, (int)floor(worldPosition.y) >> CHUNK_Y_BITS);
 }
 
+inline const WorldRenderStats& World::GetRenderStats() const
+{
+	return m_renderStats;
+}
+
+inline void World::ToggleOcclusionCulling()
+{
+	m_isOcclusionCullingEnabled = !m_isOcclusionCullingEnabled;
+	m_isDrawListDirty = true;
+}
+
+inline bool World::IsOcclusionCullingEnabled() const
+{
+	return m_isOcclusionCullingEnabled;
+}
+
+inline void World::ToggleDrawListCaching()
+{
+	m_isDrawListCachingEnabled = !m_isDrawListCachingEnabled;
+	m_isDrawListDirty = true;
+}
+
+inline bool World::IsDrawListCachingEnabled() const
+{
+	return m_isDrawListCachingEnabled;
+}
+
+inline bool World::HasDrawOrderBenchmarkResult() const
+{
+	return m_hasDrawOrderBenchmarkResult;
+}
+
+inline const DrawOrderBenchmarkResult& World::GetDrawOrderBenchmarkResult() const
+{
+	return m_drawOrderBenchmarkResult;
+}
+
+inline void World::ToggleLevelsOfDetail()
+{
+	m_areLevelsOfDetailEnabled = !m_areLevelsOfDetailEnabled;
+}
+
+inline bool World::AreLevelsOfDetailEnabled() const
+{
+	return m_areLevelsOfDetailEnabled;
+}
+
+inline int World::GetNumChunksAtLodLevel(int lodLevel) const
+{
+	return m_numChunksAtLodLevel[lodLevel];
+}
+
+inline bool World::IsDayNightCycleEnabled() const
+{
+	return m_isDayNightCycleEnabled;
+}
+
+inline unsigned int World::GetSkyLightLevel() const
+{
+	return m_skyLightLevel;
+}
+
+inline void World::ToggleFarTerrain()
+{
+	m_isFarTerrainEnabled = !m_isFarTerrainEnabled;
+}
+
+inline bool World::IsFarTerrainEnabled() const
+{
+	return m_isFarTerrainEnabled;
+}
+
+inline const FarTerrain& World::GetFarTerrain() const
+{
+	return m_farTerrain;
+}
+
+inline const TerrainColumnCache& World::GetTerrainColumnCache() const
+{
+	return m_terrainColumnCache;
+}
+
+inline const DecorationWriteStore& World::GetDecorationWriteStore() const
+{
+	return m_decorationWriteStore;
+}
+
+inline void World::PushLightEntry(LightQueue& queue, const BlockInfo& blockInfo, LightChannel channel, unsigned int lightValue)
+{
+	int slotIndex = blockInfo.m_chunk->GetLightingSlot();
+	queue.Push(PackLightEntry(slotIndex, blockInfo.m_blockIndex, channel, lightValue));
+	++m_numPendingEntriesInSlot[slotIndex];
+}
+
+inline bool World::HasPendingLighting(const Chunk* chunk) const
+{
+	return m_numPendingEntriesInSlot[chunk->GetLightingSlot()] > 0;
+}
+
+inline void World::SetLightingVisitBudget(int maxVisitsPerFrame)
+{
+	m_lightingVisitBudget = maxVisitsPerFrame;
+}
+
+inline int World::GetLightingVisitBudget() const
+{
+	return m_lightingVisitBudget;
+}
+
+inline float World::GetAverageLightEntriesPerActivation() const
+{
+	if (m_numLightingActivations == 0)
+		return 0.f;
+	return (float)m_numActivationLightEntries / (float)m_numLightingActivations;
+}
+
+inline double World::GetAverageActivationSeconds() const
+{
+	if (m_numLightingActivations == 0)
+		return 0.0;
+	return m_activationSeconds / (double)m_numLightingActivations;
+}
+
+inline double World::GetAverageLightingInitializationSeconds() const
+{
+	if (m_numLightingActivations == 0)
+		return 0.0;
+	return m_lightingInitializationSeconds / (double)m_numLightingActivations;
+}
+
+inline void World::QueueLightAddition(const BlockInfo& blockInfo, LightChannel channel)
+{
+	PushLightAddition(blockInfo, channel);
+}
+
+inline void World::ToggleParallelLighting()
+{
+	m_isParallelLightingEnabled = !m_isParallelLightingEnabled;
+}
+
+inline bool World::IsParallelLightingEnabled() const
+{
+	return m_isParallelLightingEnabled;
+}
+
+inline bool World::HasLightingDeterminismResult() const
+{
+	return m_hasLightingDeterminismResult;
+}
+
+inline int World::GetNumLightingDeterminismMismatches() const
+{
+	return m_numLightingDeterminismMismatches;
+}
+
+inline const LightingWorkStats& World::GetLightingStats() const
+{
+	return m_lightingStats;
+}
+
+inline bool World::HasLightingBenchmarkResults() const
+{
+	return m_hasLightingBenchmarkResults;
+}
+
+inline const LightingWorkStats& World::GetLightingBenchmarkResult(LightingBenchmarkEdit edit) const
+{
+	return m_lightingBenchmarkResults[edit];
+}
+
+inline void World::RunNoiseBenchmark()
+{
+	m_noiseBenchmarkResult = RunTerrainNoiseBenchmark(m_terrainGenerator.GetNoiseSettings());
+	m_hasNoiseBenchmarkResult = true;
+}
+
+inline bool World::HasNoiseBenchmarkResult() const
+{
+	return m_hasNoiseBenchmarkResult;
+}
+
+inline const NoiseBenchmarkResult& World::GetNoiseBenchmarkResult() const
+{
+	return m_noiseBenchmarkResult;
+}
+
+inline void World::RunGenerationDeterminismCheck()
+{
+	m_generationDeterminismResult = ::RunGenerationDeterminismCheck(m_terrainGenerator);
+	m_hasGenerationDeterminismResult = true;
+}
+
+inline bool World::HasGenerationDeterminismResult() const
+{
+	return m_hasGenerationDeterminismResult;
+}
+
+inline const GenerationDeterminismResult& World::GetGenerationDeterminismResult() const
+{
+	return m_generationDeterminismResult;
+}
+
+inline void World::RunTreeSiteBenchmark(const Vector3& position)
+{
+	m_treeSiteBenchmarkResult = ::RunTreeSiteBenchmark(m_terrainGenerator, GetChunkCoordsFromWorldCoords(position));
+}
+
+inline const TreeSiteBenchmarkResult& World::GetTreeSiteBenchmarkResult() const
+{
+	return m_treeSiteBenchmarkResult;
+}
+
+inline const GenerationProfile& World::GetGenerationProfile() const
+{
+	return m_generationProfile;
+}
+
 inline void World::DirtyBlockLighting(BlockInfo& blockInfo)
 {
 	if (blockInfo.GetBlock()->GetIsLightingDirty())
@@ -63,6 +485,7 @@ inline void World::DirtyBlockLighting(BlockInfo& blockInfo)
 		return;
 	}
 
-	m_dirtyLightingQueue.push_back(blockInfo);
+	//Dirty blocks are resolved for every channel, so the entry's channel is unused
+	PushLightEntry(m_dirtyLightingQueue, blockInfo, LIGHT_CHANNEL_BLOCK);
 	blockInfo.GetBlock()->SetIsLightingDirty();
 }
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "Game/WorldPregenerator.hpp"
+#include "Game/Chunk.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+PregenerationRegion::PregenerationRegion()
+	: m_minChunkCoords(0, 0)
+	, m_numChunksX(0)
+	, m_numChunksY(0)
+{
+
+}
+
+
+PregenerationResult::PregenerationResult()
+	: m_numChunks(0)
+	, m_numChunksWritten(0)
+	, m_numChunksSkipped(0)
+	, m_numWriteFailures(0)
+	, m_numThreads(0)
+	, m_seconds(0.0)
+	, m_profile()
+{
+
+}
+
+double PregenerationResult::GetChunksPerSecond() const
+{
+	if (m_seconds <= 0.0)
+		return 0.0;
+	return (double)m_numChunksWritten / m_seconds;
+}
+
+std::string PregenerationResult::GetReport() const
+{
+	std::string report = "Pregenerated chunks: " + std::to_string(m_numChunksWritten) + " of " + std::to_string(m_numChunks);
+	report += " Skipped: " + std::to_string(m_numChunksSkipped) + " Failed: " + std::to_string(m_numWriteFailures);
+	report += " Threads: " + std::to_string(m_numThreads) + " Seconds: " + std::to_string(m_seconds) + " Chunks/s: " + std::to_string(GetChunksPerSecond()) + "\n";
+	report += m_profile.GetReport() + "\n";
+	return report;
+}
+
+
+PregenerationCommandLine ParsePregenerationCommandLine(const std::string& commandLine, PregenerationRegion& out_region)
+{
+	//-pregen <chunksX> <chunksY> [<minChunkX> <minChunkY>], centered on the origin when no corner is given
+	std::istringstream commandLineStream(commandLine);
+	std::string flag;
+	if (!(commandLineStream >> flag) || flag != PREGENERATION_COMMAND_LINE_FLAG)
+		return PREGENERATION_COMMAND_LINE_ABSENT;
+
+	if (!(commandLineStream >> out_region.m_numChunksX >> out_region.m_numChunksY))
+		return PREGENERATION_COMMAND_LINE_INVALID;
+	if (out_region.m_numChunksX <= 0 || out_region.m_numChunksY <= 0)
+		return PREGENERATION_COMMAND_LINE_INVALID;
+
+	if ((commandLineStream >> std::ws).eof())
+	{
+		out_region.m_minChunkCoords = IntVector2(-out_region.m_numChunksX / 2, -out_region.m_numChunksY / 2);
+		return PREGENERATION_COMMAND_LINE_VALID;
+	}
+
+	//A corner needs both coordinates and nothing after them
+	std::string extraArgument;
+	if (!(commandLineStream >> out_region.m_minChunkCoords.x >> out_region.m_minChunkCoords.y) || (commandLineStream >> extraArgument))
+		return PREGENERATION_COMMAND_LINE_INVALID;
+	return PREGENERATION_COMMAND_LINE_VALID;
+}
+
+
+struct PregenerationWork
+{
+	const TerrainGenerator* m_generator;
+	const PregenerationRegion* m_region;
+	std::atomic<int> m_nextJobIndex;
+	std::atomic<int> m_numChunksWritten;
+	std::atomic<int> m_numChunksSkipped;
+	std::atomic<int> m_numWriteFailures;
+	std::mutex m_profileMutex;
+	GenerationProfile m_profile;
+	DecorationWriteStore m_decorationWriteStore;
+};
+
+
+static void PregenerateRowsWorker(PregenerationWork* work)
+{
+	const PregenerationRegion& region = *work->m_region;
+	int numJobs = (region.m_numChunksY + PREGENERATION_ROWS_PER_JOB - 1) / PREGENERATION_ROWS_PER_JOB;
+
+	GenerationProfile workerProfile;
+	std::vector<BlockType> blockTypes(BLOCKS_PER_CHUNK);
+	std::vector<unsigned char> fileBuffer;
+	std::vector<DecorationWrite> outsideWrites;
+	std::vector<DecorationWrite> pendingWrites;
+	for (int jobIndex = work->m_nextJobIndex++; jobIndex < numJobs; jobIndex = work->m_nextJobIndex++)
+	{
+		//Each job gets its own column cache, sized to the rows it works through and dropped with them
+		TerrainColumnCache columnCache(work->m_generator->GetNoiseSettings());
+		int startChunkY = region.m_minChunkCoords.y + (jobIndex * PREGENERATION_ROWS_PER_JOB);
+		int endChunkY = region.m_minChunkCoords.y + region.m_numChunksY;
+		if (endChunkY > startChunkY + PREGENERATION_ROWS_PER_JOB)
+			endChunkY = startChunkY + PREGENERATION_ROWS_PER_JOB;
+
+		for (int chunkY = startChunkY; chunkY < endChunkY; ++chunkY)
+		{
+			for (int chunkX = region.m_minChunkCoords.x; chunkX < region.m_minChunkCoords.x + region.m_numChunksX; ++chunkX)
+			{
+				IntVector2 chunkCoords(chunkX, chunkY);
+				std::string filePath = Chunk::GetSaveFilePath(chunkCoords);
+				if (ReadBufferFromFile(fileBuffer, filePath) && Chunk::IsSaveFileCurrent(fileBuffer))
+				{
+					++work->m_numChunksSkipped;
+					continue;
+				}
+
+				//Writes for chunks another worker has already saved stay in the store and reach them when they are next loaded
+				outsideWrites.clear();
+				work->m_generator->GenerateChunk(chunkCoords, columnCache, blockTypes.data(), outsideWrites, &workerProfile);
+				pendingWrites.clear();
+				work->m_decorationWriteStore.TakeWrites(chunkCoords, pendingWrites);
+				DecorationWriteStore::ApplyWrites(pendingWrites, blockTypes.data());
+				work->m_decorationWriteStore.AddWrites(outsideWrites);
+
+				fileBuffer.clear();
+				Chunk::CompressBlockTypesToRLE(blockTypes.data(), fileBuffer);
+				if (WriteBufferToFile(fileBuffer, filePath))
+					++work->m_numChunksWritten;
+				else
+					++work->m_numWriteFailures;
+			}
+
+			//The row below is not needed by the rows still to come in this job
+			for (int tileX = region.m_minChunkCoords.x - 1; tileX <= region.m_minChunkCoords.x + region.m_numChunksX; ++tileX)
+			{
+				columnCache.EvictTile(IntVector2(tileX, chunkY - 1));
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> profileLock(work->m_profileMutex);
+	work->m_profile.Add(workerProfile);
+}
+
+PregenerationResult PregenerateWorldRegion(const TerrainGenerator& generator, const PregenerationRegion& region)
+{
+	PregenerationResult result;
+	result.m_numChunks = region.m_numChunksX * region.m_numChunksY;
+
+	PregenerationWork work;
+	work.m_generator = &generator;
+	work.m_region = &region;
+	work.m_nextJobIndex = 0;
+	work.m_numChunksWritten = 0;
+	work.m_numChunksSkipped = 0;
+	work.m_numWriteFailures = 0;
+
+	int numJobs = (region.m_numChunksY + PREGENERATION_ROWS_PER_JOB - 1) / PREGENERATION_ROWS_PER_JOB;
+	result.m_numThreads = (int)std::thread::hardware_concurrency();
+	if (result.m_numThreads > numJobs)
+		result.m_numThreads = numJobs;
+	if (result.m_numThreads < 1)
+		result.m_numThreads = 1;
+
+	double startSeconds = GetCurrentTimeSeconds();
+
+	//The calling thread takes jobs too, so only the extra workers get their own threads
+	std::vector<std::thread> workerThreads;
+	for (int threadIndex = 1; threadIndex < result.m_numThreads; ++threadIndex)
+	{
+		workerThreads.push_back(std::thread(PregenerateRowsWorker, &work));
+	}
+
+	PregenerateRowsWorker(&work);
+
+	for (size_t threadIndex = 0; threadIndex < workerThreads.size(); ++threadIndex)
+	{
+		workerThreads[threadIndex].join();
+	}
+
+	work.m_decorationWriteStore.SaveToFiles();
+	result.m_seconds = GetCurrentTimeSeconds() - startSeconds;
+	result.m_numChunksWritten = work.m_numChunksWritten;
+	result.m_numChunksSkipped = work.m_numChunksSkipped;
+	result.m_numWriteFailures = work.m_numWriteFailures;
+	result.m_profile = work.m_profile;
+	return result;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Game/GenerationProfile.hpp"
+#include "Game/TerrainGenerator.hpp"
+#include "Engine/Math/IntVector2.hpp"
+#include <string>
+
+
+constexpr int PREGENERATION_ROWS_PER_JOB = 4;		//rows of chunks a worker takes at once, so its column cache shares tiles between the rows
+const std::string PREGENERATION_COMMAND_LINE_FLAG = "-pregen";
+const std::string PREGENERATION_REPORT_FILE_PATH = "Data/Save/Pregeneration.txt";
+const std::string PREGENERATION_USAGE = "Usage: -pregen <chunksX> <chunksY> [<minChunkX> <minChunkY>]\n";
+
+
+enum PregenerationCommandLine
+{
+	PREGENERATION_COMMAND_LINE_ABSENT,
+	PREGENERATION_COMMAND_LINE_VALID,
+	PREGENERATION_COMMAND_LINE_INVALID		//the flag was given but its arguments can't be used
+};
+
+
+//A rectangle of chunks to generate and save ahead of time
+struct PregenerationRegion
+{
+	IntVector2 m_minChunkCoords;
+	int m_numChunksX;
+	int m_numChunksY;
+
+	PregenerationRegion();
+};
+
+
+struct PregenerationResult
+{
+	int m_numChunks;
+	int m_numChunksWritten;
+	int m_numChunksSkipped;		//already saved, so player edits are never overwritten
+	int m_numWriteFailures;
+	int m_numThreads;
+	double m_seconds;
+	GenerationProfile m_profile;
+
+	PregenerationResult();
+
+	double GetChunksPerSecond() const;
+	std::string GetReport() const;
+};
+
+
+PregenerationCommandLine ParsePregenerationCommandLine(const std::string& commandLine, PregenerationRegion& out_region);
+PregenerationResult PregenerateWorldRegion(const TerrainGenerator& generator, const PregenerationRegion& region);